@@ -0,0 +1,17 @@
+#include "AllocationCounter.h"
+#include <atomic>
+
+static std::atomic<AllocationCounter::CountFunction> installedCounter(nullptr);
+
+void AllocationCounter::install(CountFunction count) {
+    installedCounter.store(count);
+}
+
+bool AllocationCounter::isInstalled() {
+    return installedCounter.load() != nullptr;
+}
+
+long long AllocationCounter::read() {
+    CountFunction count = installedCounter.load();
+    return count ? count() : -1;
+}
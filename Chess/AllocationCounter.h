@@ -0,0 +1,16 @@
+#pragma once
+
+// Heap allocation count of the process, behind the allocations reported per
+// search and per move by Game. The engine does not count allocations itself:
+// a program that replaces the global operator new (the Bench tool) installs
+// a function returning its running count. The count covers every thread, so
+// reports taken while other threads allocate include their allocations too.
+class AllocationCounter {
+public:
+    typedef long long (*CountFunction)();
+
+    static void install(CountFunction count);
+    static bool isInstalled();
+    // Allocations so far, or -1 when no counter is installed
+    static long long read();
+};
@@ -0,0 +1,104 @@
+#include "AssetPack.h"
+#include <cstdio>
+#include <cstring>
+
+static const char MAGIC[8] = { 'S', 'W', 'A', 'G', 'P', 'A', 'C', 'K' };
+static const size_t HEADER_SIZE = 12;
+static const size_t ENTRY_SIZE = AssetPack::NAME_SIZE + 8;
+static const size_t ALIGNMENT = 16;
+
+static uint32_t readU32(const unsigned char* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void writeU32(unsigned char* p, uint32_t value) {
+    for (int i = 0; i < 4; ++i) p[i] = (unsigned char)(value >> (8 * i));
+}
+
+bool AssetPack::open(const std::string& path) {
+    entries.clear();
+    if (!file.open(path)) return false;
+
+    const unsigned char* bytes = file.data();
+    size_t size = file.size();
+    if (size < HEADER_SIZE || memcmp(bytes, MAGIC, sizeof(MAGIC)) != 0) {
+        file.close();
+        return false;
+    }
+    uint32_t count = readU32(bytes + 8);
+    if (count > (size - HEADER_SIZE) / ENTRY_SIZE) {
+        file.close();
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const unsigned char* entry = bytes + HEADER_SIZE + i * ENTRY_SIZE;
+        Entry e;
+        e.name.assign((const char*)entry, strnlen((const char*)entry, NAME_SIZE));
+        e.offset = readU32(entry + NAME_SIZE);
+        e.size = readU32(entry + NAME_SIZE + 4);
+        if (e.offset > size || e.size > size - e.offset) {
+            entries.clear();
+            file.close();
+            return false;
+        }
+        entries.push_back(e);
+    }
+    return true;
+}
+
+bool AssetPack::find(const std::string& name, const unsigned char*& data, size_t& size) const {
+    // A handful of entries: a linear scan beats building an index
+    for (const Entry& e : entries) {
+        if (e.name == name) {
+            data = file.data() + e.offset;
+            size = e.size;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AssetPack::write(const std::string& path, const std::vector<std::string>& names,
+    const std::vector<std::string>& files) {
+    if (names.size() != files.size()) return false;
+
+    std::vector<std::vector<unsigned char>> contents(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (names[i].empty() || names[i].size() >= (size_t)NAME_SIZE) return false;
+        FILE* in = fopen(files[i].c_str(), "rb");
+        if (!in) return false;
+        unsigned char buffer[65536];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+            contents[i].insert(contents[i].end(), buffer, buffer + read);
+        }
+        fclose(in);
+    }
+
+    std::vector<unsigned char> header(HEADER_SIZE + ENTRY_SIZE * files.size(), 0);
+    memcpy(header.data(), MAGIC, sizeof(MAGIC));
+    writeU32(header.data() + 8, (uint32_t)files.size());
+    size_t offset = (header.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < files.size(); ++i) {
+        unsigned char* entry = header.data() + HEADER_SIZE + i * ENTRY_SIZE;
+        memcpy(entry, names[i].data(), names[i].size());
+        writeU32(entry + NAME_SIZE, (uint32_t)offset);
+        writeU32(entry + NAME_SIZE + 4, (uint32_t)contents[i].size());
+        offsets.push_back(offset);
+        offset = (offset + contents[i].size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) return false;
+    bool ok = fwrite(header.data(), 1, header.size(), out) == header.size();
+    size_t position = header.size();
+    static const unsigned char zeros[ALIGNMENT] = {};
+    for (size_t i = 0; i < files.size() && ok; ++i) {
+        ok = fwrite(zeros, 1, offsets[i] - position, out) == offsets[i] - position &&
+            fwrite(contents[i].data(), 1, contents[i].size(), out) == contents[i].size();
+        position = offsets[i] + contents[i].size();
+    }
+    return fclose(out) == 0 && ok;
+}
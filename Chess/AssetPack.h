@@ -0,0 +1,40 @@
+#pragma once
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// All game assets (piece images, UI font) in one file that is memory-mapped
+// at startup, so loading them is a lookup instead of a dozen file opens.
+// Written by the PackAssets tool.
+//
+// Layout, little-endian:
+//   magic "SWAGPACK" (8 bytes), entry count (4 bytes)
+//   entries: name (32 bytes, NUL-padded), offset (4 bytes), size (4 bytes)
+//   data of each entry at its offset, 16-byte aligned
+class AssetPack {
+public:
+    static const int NAME_SIZE = 32;
+
+    bool open(const std::string& path);
+    bool isOpen() const { return file.isOpen(); }
+
+    // Bytes of an entry, valid while the pack stays open
+    bool find(const std::string& name, const unsigned char*& data, size_t& size) const;
+    size_t getCount() const { return entries.size(); }
+
+    // Packs the files under the given entry names
+    static bool write(const std::string& path, const std::vector<std::string>& names,
+        const std::vector<std::string>& files);
+
+private:
+    struct Entry {
+        std::string name;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    MappedFile file;
+    std::vector<Entry> entries;
+};
@@ -7,6 +7,8 @@ char Bishop::getSymbol() const {
 }
 
 bool Bishop::isValidMove(int fromRow, int fromCol, int toRow, int toCol, Board* board) {
+    if (fromRow == toRow && fromCol == toCol)
+        return false;
     if (abs(fromRow - toRow) != abs(fromCol - toCol))
         return false;
 
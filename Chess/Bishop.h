@@ -7,5 +7,6 @@ public:
     bool isValidMove(int fromRow, int fromCol, int toRow, int toCol, Board* board) override;
     char getSymbol() const override;
     Piece* clone() const override { return new Bishop(isWhite); }  // For example
+    Piece* cloneInto(void* memory) const override { return new (memory) Bishop(isWhite); }
 
 };
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// 64-bit square sets. Bit index = row * 8 + col, using the same row/col
+// layout as Board::squares (row 0 is rank 8, row 7 is rank 1).
+typedef uint64_t Bitboard;
+
+inline Bitboard squareBit(int row, int col) {
+    return 1ULL << (row * 8 + col);
+}
+
+inline int popCount(Bitboard b) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(b);
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+// Index of the least significant set bit. b must not be zero.
+inline int lsb(Bitboard b) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, b);
+    return (int)index;
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+inline int popLsb(Bitboard& b) {
+    int square = lsb(b);
+    b &= b - 1;
+    return square;
+}
+
+inline Bitboard fileMask(int col) {
+    return 0x0101010101010101ULL << col;
+}
+
+inline Bitboard adjacentFilesMask(int col) {
+    return (col > 0 ? fileMask(col - 1) : 0) | (col < 7 ? fileMask(col + 1) : 0);
+}
+
+// All squares on rows strictly above (towards rank 8) / below (towards rank 1) the given row
+inline Bitboard rowsAbove(int row) {
+    return row <= 0 ? 0 : (~0ULL >> (8 * (8 - row)));
+}
+
+inline Bitboard rowsBelow(int row) {
+    return row >= 7 ? 0 : (~0ULL << (8 * (row + 1)));
+}
@@ -5,19 +5,37 @@
     #include "Bishop.h"
     #include "Queen.h"
     #include "King.h"
+    #include "Zobrist.h"
     #include <iostream>
     #include <sstream>
+    #include <cctype>
+    #include <cstring>
+    #include <algorithm>
 
 using namespace std;
     Board::Board() : shouldDeletePieces(true) {
         initialize();
     }
 
+    Board::Board(const char* fen, FenState* state) : shouldDeletePieces(true) {
+        for (int row = 0; row < 8; ++row)
+            for (int col = 0; col < 8; ++col)
+                squares[row][col] = nullptr;
+
+        FenState parsed;
+        if (!loadFEN(fen, parsed)) {
+            initialize();
+        }
+        if (state) *state = parsed;
+    }
+
     Board::~Board() {
+        // Pieces in the arena go with it; only heap fallbacks are deleted here
         if (shouldDeletePieces) {
             for (int row = 0; row < 8; ++row)
                 for (int col = 0; col < 8; ++col)
-                    delete squares[row][col];
+                    if (!pieces.owns(squares[row][col]))
+                        delete squares[row][col];
         }
     }
 
@@ -42,7 +60,7 @@ using namespace std;
         for (int row = 0; row < 8; ++row) {
             for (int col = 0; col < 8; ++col) {
                 if (other.squares[row][col] != nullptr) {
-                    squares[row][col] = other.squares[row][col]->clone();
+                    squares[row][col] = pieces.copy(other.squares[row][col]);
                 }
             }
         }
@@ -54,17 +72,19 @@ using namespace std;
             if (shouldDeletePieces) {
                 for (int row = 0; row < 8; ++row) {
                     for (int col = 0; col < 8; ++col) {
-                        delete squares[row][col];
+                        if (!pieces.owns(squares[row][col]))
+                            delete squares[row][col];
                         squares[row][col] = nullptr;
                     }
                 }
             }
+            pieces.clear();
 
             // Copy new pieces
             for (int row = 0; row < 8; ++row) {
                 for (int col = 0; col < 8; ++col) {
                     if (other.squares[row][col] != nullptr) {
-                        squares[row][col] = other.squares[row][col]->clone();
+                        squares[row][col] = pieces.copy(other.squares[row][col]);
                     }
                     else {
                         squares[row][col] = nullptr;
@@ -87,33 +107,188 @@ using namespace std;
 
 
     void Board::initialize() {
+        pieces.clear();
         for (int row = 0; row < 8; ++row)
             for (int col = 0; col < 8; ++col)
                 squares[row][col] = nullptr;
 
         // Black pieces
-        squares[0][0] = new Rook(false);
-        squares[0][1] = new Knight(false);
-        squares[0][2] = new Bishop(false);
-        squares[0][3] = new Queen(false);
-        squares[0][4] = new King(false);
-        squares[0][5] = new Bishop(false);
-        squares[0][6] = new Knight(false);
-        squares[0][7] = new Rook(false);
+        squares[0][0] = pieces.create<Rook>(false);
+        squares[0][1] = pieces.create<Knight>(false);
+        squares[0][2] = pieces.create<Bishop>(false);
+        squares[0][3] = pieces.create<Queen>(false);
+        squares[0][4] = pieces.create<King>(false);
+        squares[0][5] = pieces.create<Bishop>(false);
+        squares[0][6] = pieces.create<Knight>(false);
+        squares[0][7] = pieces.create<Rook>(false);
         for (int col = 0; col < 8; ++col)
-           squares[1][col] = new Pawn(false);
+           squares[1][col] = pieces.create<Pawn>(false);
 
         // White pieces
-        squares[7][0] = new Rook(true);
-        squares[7][1] = new Knight(true);
-        squares[7][2] = new Bishop(true);
-        squares[7][3] = new Queen(true);
-        squares[7][4] = new King(true);
-        squares[7][5] = new Bishop(true);
-        squares[7][6] = new Knight(true);
-        squares[7][7] = new Rook(true);
+        squares[7][0] = pieces.create<Rook>(true);
+        squares[7][1] = pieces.create<Knight>(true);
+        squares[7][2] = pieces.create<Bishop>(true);
+        squares[7][3] = pieces.create<Queen>(true);
+        squares[7][4] = pieces.create<King>(true);
+        squares[7][5] = pieces.create<Bishop>(true);
+        squares[7][6] = pieces.create<Knight>(true);
+        squares[7][7] = pieces.create<Rook>(true);
          for (int col = 0; col < 8; ++col)
-            squares[6][col] = new Pawn(true);
+            squares[6][col] = pieces.create<Pawn>(true);
+    }
+
+    static inline const char* skipBlanks(const char* p) {
+        while (*p == ' ' || *p == '\t') ++p;
+        return p;
+    }
+
+    static inline bool atFieldEnd(const char* p) {
+        return *p == '\0' || *p == ' ' || *p == '\t' || *p == '\r' || *p == '\n';
+    }
+
+    bool Board::loadFEN(const char* fen, FenState& state, const char** end) {
+        const char* p = skipBlanks(fen);
+
+        // 1. Piece placement, into a scratch table so a bad FEN changes nothing
+        char placement[64];
+        int row = 0, col = 0;
+        for (; !atFieldEnd(p); ++p) {
+            char c = *p;
+            if (c == '/') {
+                if (col != 8 || row == 7) return false;
+                ++row;
+                col = 0;
+            }
+            else if (c >= '1' && c <= '8') {
+                int run = c - '0';
+                if (col + run > 8) return false;
+                while (run--) placement[row * 8 + col++] = 0;
+            }
+            else {
+                switch (c | 0x20) {
+                case 'p': case 'n': case 'b': case 'r': case 'q': case 'k': break;
+                default: return false;
+                }
+                if (col > 7) return false;
+                placement[row * 8 + col++] = c;
+            }
+        }
+        if (row != 7 || col != 8) return false;
+
+        // Only positions the engine can play: one king a side, no pawn on a back rank
+        int whiteKings = 0, blackKings = 0;
+        for (int square = 0; square < 64; ++square) {
+            char symbol = placement[square];
+            if (symbol == 'K') ++whiteKings;
+            else if (symbol == 'k') ++blackKings;
+            else if ((symbol | 0x20) == 'p' && (square < 8 || square >= 56)) return false;
+        }
+        if (whiteKings != 1 || blackKings != 1) return false;
+
+        // 2. Side to move
+        p = skipBlanks(p);
+        if ((*p != 'w' && *p != 'b') || !atFieldEnd(p + 1)) return false;
+        bool whiteTurn = (*p++ == 'w');
+
+        // 3. Castling rights (optional, like the clocks in EPD)
+        int rights = 0;
+        p = skipBlanks(p);
+        if (*p == '-') {
+            ++p;
+        }
+        else {
+            for (; *p == 'K' || *p == 'Q' || *p == 'k' || *p == 'q'; ++p) {
+                rights |= *p == 'K' ? 1 : *p == 'Q' ? 2 : *p == 'k' ? 4 : 8;
+            }
+        }
+        if (!atFieldEnd(p)) return false;
+
+        // 4. En passant target
+        char epFile = 0, epRank = 0;
+        p = skipBlanks(p);
+        if (*p == '-') {
+            ++p;
+        }
+        else if (*p >= 'a' && *p <= 'h' && (p[1] == '3' || p[1] == '6')) {
+            epFile = p[0];
+            epRank = p[1];
+            p += 2;
+        }
+        if (!atFieldEnd(p)) return false;
+
+        // 5./6. Clocks, absent in EPD where operations follow instead
+        int clocks[2] = { 0, 1 };
+        for (int i = 0; i < 2; ++i) {
+            const char* q = skipBlanks(p);
+            if (*q < '0' || *q > '9') break;
+            int value = 0;
+            for (; *q >= '0' && *q <= '9'; ++q) {
+                if (value < 100000) value = value * 10 + (*q - '0');
+            }
+            if (!atFieldEnd(q)) break;
+            clocks[i] = value;
+            p = q;
+        }
+
+        // Commit. Pieces already standing on the right square are kept, which
+        // saves most allocations when loading a batch of related positions.
+        for (int r = 0; r < 8; ++r) {
+            for (int c = 0; c < 8; ++c) {
+                char symbol = placement[r * 8 + c];
+                Piece* existing = squares[r][c];
+                if (existing && shouldDeletePieces && existing->getSymbol() == symbol) continue;
+                if (shouldDeletePieces) pieces.release(existing);
+                squares[r][c] = nullptr;
+                if (!symbol) continue;
+                bool white = symbol <= 'Z';
+                switch (symbol | 0x20) {  // lowercase
+                case 'p': squares[r][c] = pieces.create<Pawn>(white); break;
+                case 'n': squares[r][c] = pieces.create<Knight>(white); break;
+                case 'b': squares[r][c] = pieces.create<Bishop>(white); break;
+                case 'r': squares[r][c] = pieces.create<Rook>(white); break;
+                case 'q': squares[r][c] = pieces.create<Queen>(white); break;
+                case 'k': squares[r][c] = pieces.create<King>(white); break;
+                }
+            }
+        }
+        shouldDeletePieces = true;
+
+        whiteCanCastleKingside = (rights & 1) != 0;
+        whiteCanCastleQueenside = (rights & 2) != 0;
+        blackCanCastleKingside = (rights & 4) != 0;
+        blackCanCastleQueenside = (rights & 8) != 0;
+
+        // Pawn::isValidMove reads en passant from the last move, so rebuild the double step
+        hasLastMove = false;
+        if (epFile) {
+            const char target[3] = { epFile, epRank, '\0' };
+            enPassantTarget = target;
+            bool whiteMoved = (epRank == '3');
+            const char from[3] = { (char)(epFile - 'a' + 'A'), whiteMoved ? '2' : '7', '\0' };
+            const char to[3] = { from[0], whiteMoved ? '4' : '5', '\0' };
+            lastMove = Move();
+            lastMove.player = whiteMoved ? "White" : "Black";
+            lastMove.fromCoord = from;
+            lastMove.toCoord = to;
+            lastMove.pieceSymbol = whiteMoved ? 'P' : 'p';
+            hasLastMove = true;
+        }
+        else {
+            enPassantTarget = "-";
+        }
+
+        state.whiteTurn = whiteTurn;
+        state.halfmoveClock = clocks[0];
+        state.fullmoveNumber = clocks[1];
+        if (end) *end = p;
+        return true;
+    }
+
+    bool Board::loadFEN(const string& fen, bool& whiteTurn) {
+        FenState state;
+        if (!loadFEN(fen.c_str(), state)) return false;
+        whiteTurn = state.whiteTurn;
+        return true;
     }
 
     void Board::printBoard() {
@@ -242,7 +417,7 @@ using namespace std;
 
         // En passant
         if (dynamic_cast<Pawn*>(piece) && fromCol != toCol && destPiece == nullptr) {
-            delete squares[fromRow][toCol];
+            pieces.release(squares[fromRow][toCol]);
             squares[fromRow][toCol] = nullptr;
         }
         // FEN string - En passant
@@ -264,16 +439,16 @@ using namespace std;
         // Promotion
         if (dynamic_cast<Pawn*>(piece)) {
             if ((isWhiteTurn && toRow == 0) || (!isWhiteTurn && toRow == 7)) {
-                delete squares[toRow][toCol];
-                squares[toRow][toCol] = new Queen(isWhiteTurn);
+                pieces.release(squares[toRow][toCol]);
+                squares[toRow][toCol] = pieces.create<Queen>(isWhiteTurn);
                 squares[fromRow][fromCol] = nullptr;
-                delete piece;
+                pieces.release(piece);
                 return true;
             }
         }
 
         // Normal move
-        delete squares[toRow][toCol];
+        pieces.release(squares[toRow][toCol]);
         squares[toRow][toCol] = piece;
         squares[fromRow][fromCol] = nullptr;
         updateCastlingRights(fromRow, fromCol, toRow, toCol);
@@ -394,9 +569,39 @@ using namespace std;
         lastMove = move;
         hasLastMove = true;
     }
-    string Board::generateFEN(bool whiteTurn, bool WhiteCastleKingside, bool WhiteCastleQueenside,
-        bool BlackCastleKingside, bool BlackCastleQueenside, int turns, int moves) const {
-        string fen;
+
+    // movePiece plus the last-move record Pawn::isValidMove reads for en passant
+    bool Board::playMove(int fromRow, int fromCol, int toRow, int toCol, bool isWhiteTurn) {
+        Piece* piece = squares[fromRow][fromCol];
+        if (!piece) return false;
+        char symbol = piece->getSymbol();  // the pawn is gone after a promotion
+        if (!movePiece(fromRow, fromCol, toRow, toCol, isWhiteTurn)) return false;
+
+        const char from[3] = { (char)('A' + fromCol), (char)('8' - fromRow), '\0' };
+        const char to[3] = { (char)('A' + toCol), (char)('8' - toRow), '\0' };
+        lastMove.player = isWhiteTurn ? "White" : "Black";
+        lastMove.fromCoord = from;
+        lastMove.toCoord = to;
+        lastMove.pieceSymbol = symbol;
+        hasLastMove = true;
+        return true;
+    }
+
+    static inline char* writeNumber(char* out, int value) {
+        char digits[12];
+        int count = 0;
+        if (value < 0) value = 0;
+        do {
+            digits[count++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value);
+        while (count) *out++ = digits[--count];
+        return out;
+    }
+
+    size_t Board::writeFEN(char* buffer, size_t capacity, bool whiteTurn, int halfmoveClock, int fullmoveNumber) const {
+        char fen[FEN_BUFFER_SIZE];
+        char* out = fen;
 
         // 1. Piece Placement
         for (int row = 0; row < 8; ++row) {
@@ -405,44 +610,230 @@ using namespace std;
                 Piece* piece = squares[row][col];
                 if (piece) {
                     if (emptyCount > 0) {
-                        fen += std::to_string(emptyCount);
+                        *out++ = (char)('0' + emptyCount);
                         emptyCount = 0;
                     }
-                    fen += piece->getSymbol();
+                    *out++ = piece->getSymbol();
                 }
                 else {
                     ++emptyCount;
                 }
             }
-            if (emptyCount > 0) {
-                fen += std::to_string(emptyCount);
-            }
-            if (row != 7) {
-                fen += '/';
-            }
+            if (emptyCount > 0) *out++ = (char)('0' + emptyCount);
+            if (row != 7) *out++ = '/';
         }
 
         // 2. Active Color
-        fen += (!whiteTurn ? " w " : " b ");
-
-        // 3. Castling Availability - Use the actual castling rights from the board
-        std::string castling;
-        if (whiteCanCastleKingside) castling += 'K';
-        if (whiteCanCastleQueenside) castling += 'Q';
-        if (blackCanCastleKingside) castling += 'k';
-        if (blackCanCastleQueenside) castling += 'q';
-        fen += (castling.empty() ? "- " : castling + " ");
+        *out++ = ' ';
+        *out++ = whiteTurn ? 'w' : 'b';
+        *out++ = ' ';
+
+        // 3. Castling Availability
+        char* castling = out;
+        if (whiteCanCastleKingside) *out++ = 'K';
+        if (whiteCanCastleQueenside) *out++ = 'Q';
+        if (blackCanCastleKingside) *out++ = 'k';
+        if (blackCanCastleQueenside) *out++ = 'q';
+        if (out == castling) *out++ = '-';
+        *out++ = ' ';
 
         // 4. En Passant Target Square
-        fen += enPassantTarget.empty() ? "- " : enPassantTarget + " ";
+        if (enPassantTarget.size() == 2) {
+            *out++ = enPassantTarget[0];
+            *out++ = enPassantTarget[1];
+        }
+        else {
+            *out++ = '-';
+        }
+        *out++ = ' ';
+
+        // 5. Halfmove Clock, 6. Fullmove Number
+        out = writeNumber(out, halfmoveClock);
+        *out++ = ' ';
+        out = writeNumber(out, fullmoveNumber);
+
+        size_t length = (size_t)(out - fen);
+        if (length + 1 > capacity) return 0;
+        memcpy(buffer, fen, length);
+        buffer[length] = '\0';
+        return length;
+    }
+
+    // Kept for the move log: callers pass the side that just moved and the ply count
+    string Board::generateFEN(bool whiteTurn, bool WhiteCastleKingside, bool WhiteCastleQueenside,
+        bool BlackCastleKingside, bool BlackCastleQueenside, int turns, int moves) const {
+        char fen[FEN_BUFFER_SIZE];
+        size_t length = writeFEN(fen, sizeof(fen), !whiteTurn, turns, moves / 2);
+        return string(fen, length);
+    }
+
+    int Board::pieceValue(char symbol) {
+        switch (toupper(symbol)) {
+        case 'P': return 100;
+        case 'N': return 320;
+        case 'B': return 330;
+        case 'R': return 500;
+        case 'Q': return 900;
+        case 'K': return 20000;
+        }
+        return 0;
+    }
+
+    Bitboard Board::getOccupancy() const {
+        Bitboard occupied = 0;
+        for (int row = 0; row < 8; ++row)
+            for (int col = 0; col < 8; ++col)
+                if (squares[row][col]) occupied |= squareBit(row, col);
+        return occupied;
+    }
+
+    Bitboard Board::getColorOccupancy(bool white) const {
+        Bitboard occupied = 0;
+        for (int row = 0; row < 8; ++row)
+            for (int col = 0; col < 8; ++col)
+                if (squares[row][col] && squares[row][col]->isWhitePiece() == white)
+                    occupied |= squareBit(row, col);
+        return occupied;
+    }
+
+    Bitboard Board::attackersTo(int row, int col, Bitboard occupied) const {
+        Bitboard attackers = 0;
+        auto symbolAt = [&](int r, int c) -> char {
+            if (!(occupied & squareBit(r, c)) || !squares[r][c]) return 0;
+            return squares[r][c]->getSymbol();
+        };
+
+        // Pawns: a white pawn attacks from the row below, a black pawn from the row above
+        for (int dc = -1; dc <= 1; dc += 2) {
+            int c = col + dc;
+            if (c < 0 || c > 7) continue;
+            if (row + 1 <= 7 && symbolAt(row + 1, c) == 'P') attackers |= squareBit(row + 1, c);
+            if (row - 1 >= 0 && symbolAt(row - 1, c) == 'p') attackers |= squareBit(row - 1, c);
+        }
+
+        // Knights and kings
+        static const int knightSteps[8][2] = { {-2,-1},{-2,1},{-1,-2},{-1,2},{1,-2},{1,2},{2,-1},{2,1} };
+        static const int kingSteps[8][2] = { {-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1} };
+        for (int i = 0; i < 8; ++i) {
+            int r = row + knightSteps[i][0], c = col + knightSteps[i][1];
+            if (r >= 0 && r < 8 && c >= 0 && c < 8 && toupper(symbolAt(r, c)) == 'N')
+                attackers |= squareBit(r, c);
+            r = row + kingSteps[i][0];
+            c = col + kingSteps[i][1];
+            if (r >= 0 && r < 8 && c >= 0 && c < 8 && toupper(symbolAt(r, c)) == 'K')
+                attackers |= squareBit(r, c);
+        }
+
+        // Sliders: the first occupied square along each ray
+        for (int i = 0; i < 8; ++i) {
+            int dr = kingSteps[i][0], dc = kingSteps[i][1];
+            bool diagonal = dr != 0 && dc != 0;
+            int r = row + dr, c = col + dc;
+            while (r >= 0 && r < 8 && c >= 0 && c < 8) {
+                char symbol = (char)toupper(symbolAt(r, c));
+                if (symbol) {
+                    if (symbol == 'Q' || (diagonal ? symbol == 'B' : symbol == 'R'))
+                        attackers |= squareBit(r, c);
+                    break;
+                }
+                r += dr;
+                c += dc;
+            }
+        }
+        return attackers;
+    }
+
+    int Board::staticExchange(int fromRow, int fromCol, int toRow, int toCol) const {
+        Piece* mover = squares[fromRow][fromCol];
+        if (!mover) return 0;
+        Piece* target = squares[toRow][toCol];
+
+        int gain[32];
+        int depth = 0;
+        Bitboard occupied = getOccupancy();
+        gain[0] = target ? pieceValue(target->getSymbol()) : 0;
+
+        // En passant: the captured pawn is beside the target square
+        if (!target && toupper(mover->getSymbol()) == 'P' && fromCol != toCol) {
+            gain[0] = pieceValue('P');
+            occupied &= ~squareBit(fromRow, toCol);
+        }
+
+        Bitboard whitePieces = getColorOccupancy(true);
+        bool sideWhite = !mover->isWhitePiece();
+        int attackerValue = pieceValue(mover->getSymbol());
+        occupied &= ~squareBit(fromRow, fromCol);
+        Bitboard attackers = attackersTo(toRow, toCol, occupied);
+
+        static const char order[6] = { 'P', 'N', 'B', 'R', 'Q', 'K' };
+        while (depth < 31) {
+            Bitboard own = attackers & occupied & (sideWhite ? whitePieces : ~whitePieces);
+            if (!own) break;
+
+            // Least valuable attacker of the side to recapture
+            int square = -1;
+            char symbol = 0;
+            for (char type : order) {
+                Bitboard candidates = own;
+                while (candidates) {
+                    int s = popLsb(candidates);
+                    if (toupper(squares[s / 8][s % 8]->getSymbol()) == type) {
+                        square = s;
+                        symbol = type;
+                        break;
+                    }
+                }
+                if (square >= 0) break;
+            }
 
-        // 5. Halfmove Clock
-        fen += std::to_string(turns) + " ";
+            // The king may only recapture when nothing defends the square any more
+            Bitboard enemy = attackers & occupied & ~squareBit(square / 8, square % 8) &
+                (sideWhite ? ~whitePieces : whitePieces);
+            if (symbol == 'K' && enemy) break;
+
+            ++depth;
+            gain[depth] = attackerValue - gain[depth - 1];
+            attackerValue = pieceValue(symbol);
+            occupied &= ~squareBit(square / 8, square % 8);
+            attackers = attackersTo(toRow, toCol, occupied);  // reveals x-ray attackers
+            sideWhite = !sideWhite;
+        }
 
-        // 6. Fullmove Number
-        fen += std::to_string(moves / 2);
+        while (depth > 0) {
+            gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+            --depth;
+        }
+        return gain[0];
+    }
 
-        return fen;
+    int Board::getCastlingRights() const {
+        return (whiteCanCastleKingside ? 1 : 0) | (whiteCanCastleQueenside ? 2 : 0) |
+            (blackCanCastleKingside ? 4 : 0) | (blackCanCastleQueenside ? 8 : 0);
+    }
+
+    uint64_t Board::getHashKey(bool whiteTurn) const {
+        uint64_t key = 0;
+        for (int row = 0; row < 8; ++row)
+            for (int col = 0; col < 8; ++col)
+                if (Piece* piece = squares[row][col])
+                    key ^= Zobrist::piece(piece->getSymbol(), row, col);
+
+        if (whiteTurn) key ^= Zobrist::sideToMove();
+        key ^= Zobrist::castling(getCastlingRights());
+        if (enPassantTarget.size() == 2)
+            key ^= Zobrist::enPassant(enPassantTarget[0] - 'a');
+        return key;
+    }
+
+    uint64_t Board::getPawnKey() const {
+        uint64_t key = 0;
+        for (int row = 1; row < 7; ++row)
+            for (int col = 0; col < 8; ++col) {
+                Piece* piece = squares[row][col];
+                if (piece && toupper(piece->getSymbol()) == 'P')
+                    key ^= Zobrist::piece(piece->getSymbol(), row, col);
+            }
+        return key;
     }
 
     std::string Board::getSimplePosition(bool isWhiteTurn) const {
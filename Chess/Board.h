@@ -1,11 +1,23 @@
 ﻿#pragma once
 #include "Piece.h"
+#include "PieceArena.h"
 #include "Moves.h"
 #include "King.h"
+#include "Bitboard.h"
+#include <cstdint>
 using namespace std;
+
+// FEN fields besides the piece placement and castling rights, which live in the Board
+struct FenState {
+    bool whiteTurn = true;
+    int halfmoveClock = 0;
+    int fullmoveNumber = 1;
+};
+
 class Board {
 private:
     Piece* squares[8][8];
+    PieceArena pieces;  // storage of the pieces on the squares
     bool shouldDeletePieces;
     Move lastMove;
     bool hasLastMove = false;
@@ -17,11 +29,23 @@ private:
 
 public:
     Board();
+    explicit Board(const char* fen, FenState* state = nullptr);  // start position if the FEN is malformed
     ~Board();
     Board(const Board& other);
     Board& operator=(const Board& other);
 
     void initialize();
+    // FEN/EPD parsing straight from the text, no intermediate strings. Replaces
+    // the position; a malformed FEN returns false and leaves the board as it was.
+    // So does a position without exactly one king a side or with a pawn on a back rank.
+    // The clocks are optional (EPD); 'end' receives where EPD operations start.
+    bool loadFEN(const char* fen, FenState& state, const char** end = nullptr);
+    bool loadFEN(const string& fen, bool& whiteTurn);
+
+    // Writes a NUL-terminated FEN into the caller's buffer without allocating.
+    // Returns its length, or 0 if the buffer is too small; FEN_BUFFER_SIZE always fits.
+    static const size_t FEN_BUFFER_SIZE = 128;
+    size_t writeFEN(char* buffer, size_t capacity, bool whiteTurn, int halfmoveClock, int fullmoveNumber) const;
     void printBoard();
 
     Piece* getPiece(int row, int col) const;
@@ -29,6 +53,7 @@ public:
     void setPiece(int col, int row, Piece* piece); //  for king safety simulation
 
     bool movePiece(int fromRow, int fromCol, int toRow, int toCol, bool isWhiteTurn);
+    bool playMove(int fromRow, int fromCol, int toRow, int toCol, bool isWhiteTurn);  // movePiece + setLastMove
 
     void setLastMove(const Move& move);  //  declared properly
 
@@ -45,6 +70,16 @@ public:
     bool isStalemate(bool isWhiteKing);
     string getSimplePosition(bool whiteTurn) const;
     bool insufficientMaterialCheck();
+    // Attack maps and static exchange evaluation
+    Bitboard getOccupancy() const;
+    Bitboard getColorOccupancy(bool white) const;
+    Bitboard attackersTo(int row, int col, Bitboard occupied) const;  // both colors, sliders see through removed pieces
+    int staticExchange(int fromRow, int fromCol, int toRow, int toCol) const;  // expected material gain of the capture
+    static int pieceValue(char symbol);
+    uint64_t getHashKey(bool whiteTurn) const;  // Zobrist key of the whole position
+    uint64_t getPawnKey() const;                // Zobrist key of the pawns only, for the pawn hash
+    int getCastlingRights() const;              // K = 1, Q = 2, k = 4, q = 8
+    const string& getEnPassantTarget() const { return enPassantTarget; }  // "e3", or "-"
     string generateFEN(bool whiteTurn, bool WhiteCastleKingside, bool WhiteCastleQueenside, bool BlackCastleKingside, bool BlackCastleQueenside, int turns, int moves) const;
     // Add getter methods for castling rights
     bool getWhiteCanCastleKingside() const { return whiteCanCastleKingside; }
@@ -1,20 +1,24 @@
 #include <SFML/Graphics.hpp>
 #include "ChessGUI.h"
+#include "Tablebase.h"
+#include "OpeningBook.h"
+#include "Trace.h"
 #include <iostream>
 
 int main() {
+    sf::Clock startupClock;
+
+    // Endgame tables are optional; build them with the TablebaseGen tool
+    Tablebase::init(Tablebase::DEFAULT_DIRECTORY);
+    // Polyglot book: the Random64 key table and a .bin book, both optional
+    if (OpeningBook::loadKeys("books/polyglot_random64.txt")) OpeningBook::open("books/book.bin");
+
     // Create mode selection window
     sf::RenderWindow window(sf::VideoMode({ 600u, 400u }), "Swag Chess - Select Mode");
 
     sf::Font font;
-    if (!font.openFromFile("C:\\Users\\User\\source\\repos\\swag-chess\\Chess\\arial.ttf")) {
-        // Try alternative font locations
-        if (!font.openFromFile("C:/Windows/Fonts/arial.ttf") &&
-            !font.openFromFile("/System/Library/Fonts/Arial.ttf") &&
-            !font.openFromFile("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf")) {
-            std::cerr << "Could not load any font!" << std::endl;
-            return 1;
-        }
+    if (!ChessGUI::loadFont(font)) {
+        return 1;
     }
 
     sf::Text title(font);
@@ -54,9 +58,25 @@ int main() {
     aiWhiteText.setFillColor(sf::Color::Black);
 
     int selectedMode = 0; // 0 = no selection, 1 = multiplayer, 2 = AI as black, 3 = AI as white
+    bool firstFrame = true;
 
     while (window.isOpen()) {
-        while (auto event = window.pollEvent()) {
+        // The menu is static: draw it, then sleep until the next event
+        window.clear(sf::Color(30, 30, 30));
+        window.draw(title);
+        window.draw(multiButton);
+        window.draw(multiText);
+        window.draw(aiButton);
+        window.draw(aiText);
+        window.draw(aiWhiteButton);
+        window.draw(aiWhiteText);
+        window.display();
+        if (firstFrame) {
+            firstFrame = false;
+            std::cout << "Menu ready in " << startupClock.getElapsedTime().asMilliseconds() << " ms" << std::endl;
+        }
+
+        if (const auto event = window.waitEvent()) {
             if (event->is<sf::Event::Closed>()) {
                 window.close();
                 return 0;
@@ -81,16 +101,6 @@ int main() {
                 }
             }
         }
-
-        window.clear(sf::Color(30, 30, 30));
-        window.draw(title);
-        window.draw(multiButton);
-        window.draw(multiText);
-        window.draw(aiButton);
-        window.draw(aiText);
-        window.draw(aiWhiteButton);
-        window.draw(aiWhiteText);
-        window.display();
     }
 
     // Launch the chess game based on selection
@@ -125,5 +135,6 @@ int main() {
         }
     }
 
+    TRACE_WRITE("chess_trace.json");
     return 0;
 }
\ No newline at end of file
@@ -1,18 +1,56 @@
 #include "ChessGUI.h"
 #include "Pawn.h"
+#include "AssetPack.h"
+#include "Trace.h"
 #include <iostream>
 #include <filesystem>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <cstdio>
+
+static const char* PIECE_ORDER = "prnbqk";
+
+// Loose files are looked up relative to the working directory: the build
+// or Chess folder, or the repository root
+static const char* ASSET_PACK_PATH = "assets.pack";
+static const char* ASSET_DIRECTORIES[] = { "assets/", "Chess/assets/" };
+static const char* FONT_NAME = "arial.ttf";
+static const char* FRAME_CSV_PATH = "frame_times.csv";
+static const char* FONT_PATHS[] = {
+    "arial.ttf",
+    "Chess/arial.ttf",
+    "assets/arial.ttf",
+    "C:/Windows/Fonts/arial.ttf",
+    "/System/Library/Fonts/Supplemental/Arial.ttf",
+    "/System/Library/Fonts/Arial.ttf",
+    "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+    "/usr/share/fonts/TTF/DejaVuSans.ttf",
+    "/usr/share/fonts/dejavu/DejaVuSans.ttf"
+};
+
+// Mapped once and kept for the whole run: fonts opened from memory read it lazily
+static const AssetPack& getAssetPack() {
+    static AssetPack pack;
+    static bool opened = pack.open(ASSET_PACK_PATH);
+    (void)opened;
+    return pack;
+}
 
 ChessGUI::ChessGUI(bool playVsAI, bool aiPlaysWhite)
     : window(sf::VideoMode({ 800u, 800u }), "Swag Chess"),
+    pieceVertices(sf::PrimitiveType::Triangles), piecesDirty(true),
     pieceSelected(false), selectedRow(-1), selectedCol(-1),
     gameOver(false), vsAI(playVsAI), aiIsWhite(aiPlaysWhite),
+    boardVertices(sf::PrimitiveType::Triangles), coordinateVertices(sf::PrimitiveType::Triangles),
+    highlightVertices(sf::PrimitiveType::Triangles), highlightsDirty(true),
     statusText(font), turnText(font), newGameText(font), modeText(font),
-    fiftyMoveCounter(0) {  // Add aiThinking flag
-
-    // Initialize highlight square
-    highlightSquare.setSize(sf::Vector2f(SQUARE_SIZE, SQUARE_SIZE));
-    highlightSquare.setFillColor(getHighlightColor());
+    analysisButtonText(font), analysisText(font), analysisMode(false), analysisGeneration(0),
+    evalBarVertices(sf::PrimitiveType::Triangles), hudVisible(false), hudText(font),
+    hudVertices(sf::PrimitiveType::Triangles), aiThinking(false), needsRedraw(true), frameLimit(DEFAULT_FRAME_LIMIT),
+    firstFrameShown(false), fiftyMoveCounter(0) {
 
     // Initialize UI elements
     newGameButton.setSize(sf::Vector2f(120, 40));
@@ -23,6 +61,10 @@ ChessGUI::ChessGUI(bool playVsAI, bool aiPlaysWhite)
     modeButton.setPosition(sf::Vector2f(150, 20));
     modeButton.setFillColor(sf::Color(180, 130, 70));
 
+    analysisButton.setSize(sf::Vector2f(120, 40));
+    analysisButton.setPosition(sf::Vector2f(280, 20));
+    analysisButton.setFillColor(sf::Color(110, 150, 90));
+
     // Initialize AI thinking timer
     aiThinkTimer = sf::Time::Zero;
 }
@@ -32,51 +74,40 @@ ChessGUI::~ChessGUI() {
 }
 
 bool ChessGUI::checkThreefoldRepetition() {
-    if (positionHistory.size() < 8) return false; // Need at least 4 previous positions
-
-    // Get current position
-    std::string currentPosition = game.getBoard().getSimplePosition(game.isWhiteTurn());
-
-    // Count occurrences of current position in history
-    int count = 1; // Start with 1 for current position
-    for (const auto& pos : positionHistory) {
-        if (pos == currentPosition) {
-            count++;
-        }
-    }
-
-    // Threefold repetition occurs when position appears 3 or more times
-    return count >= 3;
+    // The game keeps the position keys, so the search sees the same history
+    return game.getStatus() == GameStatus::ThreefoldRepetition;
 }
 
 // Add this method to check fifty move rule:
 bool ChessGUI::checkFiftyMoveRule() {
-    return fiftyMoveCounter >= 100;
+    return game.getStatus() == GameStatus::FiftyMoveRule;
 }
 
-void ChessGUI::updateDrawConditions() {
+void ChessGUI::updateDrawConditions(bool irreversible) {
     // Add current position to history AFTER making the move
-    std::string currentPosition = game.getBoard().getSimplePosition(game.isWhiteTurn());
-    positionHistory.push_back(currentPosition);
+    game.recordPosition(game.isWhiteTurn(), irreversible);
+}
 
-    // Keep position history reasonable size (last 150 positions should be enough)
-    if (positionHistory.size() > 150) {
-        positionHistory.erase(positionHistory.begin());
+bool ChessGUI::loadFont(sf::Font& font) {
+    const unsigned char* data;
+    size_t size;
+    if (getAssetPack().find(FONT_NAME, data, size) && font.openFromMemory(data, size)) {
+        return true;
+    }
+    for (const char* path : FONT_PATHS) {
+        if (std::filesystem::exists(path) && font.openFromFile(path)) {
+            return true;
+        }
     }
+    std::cerr << "Could not load any font!" << std::endl;
+    return false;
 }
 
 bool ChessGUI::initialize() {
+    sf::Clock assetClock;
+
     // Load font FIRST before setting up any text elements
-    if (!font.openFromFile("C:\\Users\\User\\source\\repos\\swag-chess\\Chess\\arial.ttf")) {
-        // Try alternative font locations
-        if (!font.openFromFile("C:/Windows/Fonts/arial.ttf") &&
-            !font.openFromFile("C:/Windows/Fonts/Arial.ttf") &&
-            !font.openFromFile("/System/Library/Fonts/Arial.ttf") &&
-            !font.openFromFile("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf") &&
-            !font.openFromFile("assets/arial.ttf")) {
-            std::cerr << "Could not load any font! Trying to create default font..." << std::endl;
-        }
-    }
+    loadFont(font);
 
     // Setup text elements AFTER font is loaded
     statusText.setFont(font);
@@ -100,14 +131,33 @@ bool ChessGUI::initialize() {
     modeText.setCharacterSize(14);
     modeText.setFillColor(sf::Color::White);
     modeText.setPosition(sf::Vector2f(175, 30));
-    
+
+    analysisButtonText.setFont(font);
+    analysisButtonText.setString("Analysis: Off");
+    analysisButtonText.setCharacterSize(14);
+    analysisButtonText.setFillColor(sf::Color::White);
+    analysisButtonText.setPosition(sf::Vector2f(295, 30));
+
+    analysisText.setFont(font);
+    analysisText.setCharacterSize(14);
+    analysisText.setFillColor(sf::Color::White);
+    analysisText.setPosition(sf::Vector2f(420, 20));
+
+    hudText.setFont(font);
+    hudText.setCharacterSize(12);
+    hudText.setFillColor(sf::Color::White);
+    hudText.setPosition(sf::Vector2f(570, 90));
+
+    // Coordinate glyphs come from the font, so build the board once it is loaded
+    buildBoardVertices();
 
     // Load piece textures
     if (!loadPieceTextures()) {
         std::cerr << "Failed to load piece textures!" << std::endl;
         return false;
     }
-    
+    std::cout << "Assets loaded in " << assetClock.getElapsedTime().asMilliseconds() << " ms from "
+        << (getAssetPack().isOpen() ? ASSET_PACK_PATH : "asset files") << std::endl;
 
     // Initialize game
     game = Game();
@@ -117,77 +167,189 @@ bool ChessGUI::initialize() {
     if (vsAI && aiIsWhite) {
         aiThinking = true;
         aiThinkTimer = sf::Time::Zero;
+        updateGameStatus();
     }
     return true;
 }
 
 bool ChessGUI::loadPieceTextures() {
-    std::vector<std::string> pieces = { "wp", "wr", "wn", "wb", "wq", "wk",
-                                       "bp", "br", "bn", "bb", "bq", "bk" };
- 
-    for (const std::string& piece : pieces) {
-        sf::Texture texture;
-        std::string path =  "C:\\Users\\User\\source\\repos\\swag-chess\\Chess\\assets\\" + piece + ".png";
-
-        if (!texture.loadFromFile(path)) {
-            std::cerr << "Failed to load texture: " << path << std::endl;
+    // Decode the twelve images in parallel, then pack them into one texture
+    const AssetPack& pack = getAssetPack();
+    sf::Image images[2 * PIECE_TYPES];
+    bool loaded[2 * PIECE_TYPES] = {};
+    std::atomic<int> next(0);
+    auto decode = [&]() {
+        for (int i = next++; i < 2 * PIECE_TYPES; i = next++) {
+            std::string name = std::string(1, i < PIECE_TYPES ? 'w' : 'b') + PIECE_ORDER[i % PIECE_TYPES] + ".png";
+            const unsigned char* data;
+            size_t size;
+            if (pack.find(name, data, size)) {
+                loaded[i] = images[i].loadFromMemory(data, size);
+                continue;
+            }
+            for (const char* directory : ASSET_DIRECTORIES) {
+                std::string path = directory + name;
+                if (std::filesystem::exists(path)) {
+                    loaded[i] = images[i].loadFromFile(path);
+                    break;
+                }
+            }
+        }
+    };
+    unsigned workers = std::min(std::max(1u, std::thread::hardware_concurrency()), (unsigned)(2 * PIECE_TYPES));
+    std::vector<std::thread> threads;
+    for (unsigned w = 1; w < workers; w++) {
+        threads.emplace_back(decode);
+    }
+    decode();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    sf::Vector2u cell(0, 0);
+    for (int i = 0; i < 2 * PIECE_TYPES; i++) {
+        if (!loaded[i]) {
+            std::cerr << "Failed to load texture: " << (i < PIECE_TYPES ? 'w' : 'b') << PIECE_ORDER[i % PIECE_TYPES]
+                << ".png" << std::endl;
             return false;
         }
+        cell.x = std::max(cell.x, images[i].getSize().x);
+        cell.y = std::max(cell.y, images[i].getSize().y);
+    }
 
-        pieceTextures[piece] = std::move(texture);
+    // Padding keeps neighbouring pieces from bleeding in when scaled
+    sf::Vector2u stride(cell.x + ATLAS_PADDING, cell.y + ATLAS_PADDING);
+    sf::Image atlas;
+    atlas.resize(sf::Vector2u(stride.x * PIECE_TYPES, stride.y * 2), sf::Color::Transparent);
+    for (int i = 0; i < 2 * PIECE_TYPES; i++) {
+        sf::Vector2u position(stride.x * (i % PIECE_TYPES), stride.y * (i / PIECE_TYPES));
+        atlas.copy(images[i], position);
+        pieceRects[i] = sf::FloatRect(sf::Vector2f(position), sf::Vector2f(images[i].getSize()));
     }
 
+    if (!pieceAtlas.loadFromImage(atlas)) {
+        std::cerr << "Failed to create the piece atlas" << std::endl;
+        return false;
+    }
+    piecesDirty = true;
     return true;
 }
 
+// Nothing is waiting to happen without user input
+bool ChessGUI::isIdle() {
+    return !aiThinking && (gameOver || !vsAI || game.isWhiteTurn() != aiIsWhite);
+}
+
 void ChessGUI::run() {
+    TRACE_THREAD_NAME("gui");
     sf::Clock clock;
+    sf::Clock frameClock;
 
     while (window.isOpen()) {
-        sf::Time deltaTime = clock.restart();
+        if (isIdle()) {
+            // Block until the user does something instead of spinning; while
+            // analysing, wake up once a frame to pick up the search's progress
+            sf::Time timeout = analysisMode
+                ? sf::microseconds(1000000 / (frameLimit > 0 ? frameLimit : DEFAULT_FRAME_LIMIT))
+                : sf::Time::Zero;
+            if (const std::optional<sf::Event> event = window.waitEvent(timeout)) {
+                handleEvent(*event);
+            }
+            clock.restart();  // time spent waiting must not count towards the AI delay
+        }
+        frameClock.restart();
+        profiler.beginFrame();
 
         handleEvents();
-        update(deltaTime);  // Pass deltaTime to update
-        render();
+        if (analysisMode && pollAnalysis()) {
+            needsRedraw = true;
+        }
+        profiler.mark(FrameStage::Events);
+        update(clock.restart());
+        profiler.mark(FrameStage::Update);
+        if (needsRedraw && window.isOpen()) {
+            render();
+            profiler.endFrame();
+        }
+
+        // While animating, hold the frame rate instead of redrawing flat out
+        if (!isIdle() && frameLimit > 0) {
+            sf::Time frame = sf::microseconds(1000000 / frameLimit);
+            sf::Time elapsed = frameClock.getElapsedTime();
+            if (elapsed < frame) {
+                sf::sleep(frame - elapsed);
+            }
+        }
     }
 }
 
 void ChessGUI::handleEvents() {
-    while (auto event = window.pollEvent()) {
-        if (event->is<sf::Event::Closed>()) {
-            window.close();
+    while (const std::optional<sf::Event> event = window.pollEvent()) {
+        handleEvent(*event);
+    }
+}
+
+void ChessGUI::handleEvent(const sf::Event& event) {
+    // Pointer motion changes nothing on screen; anything else (clicks,
+    // resizes, regained focus) gets a fresh frame
+    if (!event.is<sf::Event::MouseMoved>()) {
+        needsRedraw = true;
+    }
+
+    if (event.is<sf::Event::Closed>()) {
+        window.close();
+        return;
+    }
+
+    if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>()) {
+        if (keyPressed->code == sf::Keyboard::Key::F3) {
+            hudVisible = !hudVisible;
+        }
+        else if (keyPressed->code == sf::Keyboard::Key::F12) {
+            if (profiler.writeCsv(FRAME_CSV_PATH)) {
+                std::cout << "Frame times written to " << FRAME_CSV_PATH << std::endl;
+            }
+            else {
+                std::cerr << "Could not write " << FRAME_CSV_PATH << std::endl;
+            }
         }
+        return;
+    }
 
-        if (const auto* mousePressed = event->getIf<sf::Event::MouseButtonPressed>()) {
-            if (mousePressed->button == sf::Mouse::Button::Left) {
-                sf::Vector2i mousePos = sf::Vector2i(mousePressed->position);
+    if (const auto* mousePressed = event.getIf<sf::Event::MouseButtonPressed>()) {
+        if (mousePressed->button == sf::Mouse::Button::Left) {
+            sf::Vector2i mousePos = sf::Vector2i(mousePressed->position);
 
-                // Check UI button clicks
-                if (newGameButton.getGlobalBounds().contains(sf::Vector2f(mousePos))) {
-                    resetGame();
-                    continue;
-                }
+            // Check UI button clicks
+            if (newGameButton.getGlobalBounds().contains(sf::Vector2f(mousePos))) {
+                resetGame();
+                return;
+            }
 
-                if (modeButton.getGlobalBounds().contains(sf::Vector2f(mousePos))) {
-                    toggleMode();
-                    continue;
-                }
+            if (modeButton.getGlobalBounds().contains(sf::Vector2f(mousePos))) {
+                toggleMode();
+                return;
+            }
 
-                // Handle board clicks only if it's human's turn and AI is not thinking
-                if (!gameOver && !aiThinking && (!vsAI || (vsAI && game.isWhiteTurn() != aiIsWhite))) {
-                    sf::Vector2i boardPos = getBoardPosition(mousePos);
+            if (analysisButton.getGlobalBounds().contains(sf::Vector2f(mousePos))) {
+                toggleAnalysis();
+                return;
+            }
+
+            // Handle board clicks only if it's human's turn and AI is not thinking
+            if (!gameOver && !aiThinking && (!vsAI || (vsAI && game.isWhiteTurn() != aiIsWhite))) {
+                sf::Vector2i boardPos = getBoardPosition(mousePos);
 
-                    if (isValidBoardPosition(boardPos)) {
-                        if (!pieceSelected) {
-                            selectPiece(boardPos.y, boardPos.x);
+                if (isValidBoardPosition(boardPos)) {
+                    if (!pieceSelected) {
+                        selectPiece(boardPos.y, boardPos.x);
+                    }
+                    else {
+                        if (boardPos.x == selectedCol && boardPos.y == selectedRow) {
+                            clearSelection();
                         }
                         else {
-                            if (boardPos.x == selectedCol && boardPos.y == selectedRow) {
-                                clearSelection();
-                            }
-                            else {
-                                movePiece(boardPos.y, boardPos.x);
-                            }
+                            movePiece(boardPos.y, boardPos.x);
                         }
                     }
                 }
@@ -197,7 +359,7 @@ void ChessGUI::handleEvents() {
 }
 
 void ChessGUI::update(sf::Time deltaTime) {
-    updateGameStatus();
+    // Game status is refreshed when a move is played, not every frame
 
     // Handle AI thinking with delay
     if (!gameOver && vsAI && game.isWhiteTurn() == aiIsWhite) {
@@ -205,6 +367,7 @@ void ChessGUI::update(sf::Time deltaTime) {
             // Start AI thinking
             aiThinking = true;
             aiThinkTimer = sf::Time::Zero;
+            updateGameStatus();
             // Update status to show AI is thinking
             if (aiIsWhite) {
                 statusText.setString("White (Bird) is thinking...");
@@ -229,14 +392,32 @@ void ChessGUI::update(sf::Time deltaTime) {
 }
 
 void ChessGUI::render() {
+    needsRedraw = false;
     window.clear(sf::Color(40, 40, 40));
 
     drawBoard();
+    profiler.mark(FrameStage::Board);
     drawHighlights();
+    profiler.mark(FrameStage::Highlights);
     drawPieces();
+    profiler.mark(FrameStage::Pieces);
     drawUI();
+    if (analysisMode) {
+        drawAnalysis();
+    }
+    profiler.mark(FrameStage::Ui);
+    if (hudVisible) {
+        drawHud();
+    }
+    profiler.mark(FrameStage::Hud);
 
     window.display();
+    profiler.mark(FrameStage::Display);
+
+    if (!firstFrameShown) {
+        firstFrameShown = true;
+        std::cout << "First frame after " << startupClock.getElapsedTime().asMilliseconds() << " ms" << std::endl;
+    }
 }
 
 sf::Vector2i ChessGUI::getBoardPosition(sf::Vector2i mousePos) {
@@ -250,53 +431,31 @@ bool ChessGUI::isValidBoardPosition(sf::Vector2i pos) {
 }
 
 void ChessGUI::selectPiece(int row, int col) {
-    Board& board = game.getBoard();
-    Piece* piece = board.getPiece(row, col);
+    Piece* piece = game.getBoard().getPiece(row, col);
 
     if (piece && piece->isWhitePiece() == game.isWhiteTurn()) {
         pieceSelected = true;
         selectedRow = row;
         selectedCol = col;
 
-        // Calculate valid moves - but only show LEGAL moves
+        // Legal targets come precomputed from Game, including castling and en passant
         validMoves.clear();
-        for (int r = 0; r < 8; r++) {
-            for (int c = 0; c < 8; c++) {
-                // First check if the piece can theoretically move there
-                if (piece->isValidMove(row, col, r, c, &board)) {
-                    // Then check if this move would be legal (using the same logic as movePiece)
-
-                    // Simulate the move to see if it exposes the king
-                    Piece* tempFrom = board.getPiece(row, col);
-                    Piece* tempTo = board.getPiece(r, c);
-
-                    // Temporarily make the move
-                    board.setPiece(r, c, tempFrom);
-                    board.setPiece(row, col, nullptr);
-
-                    // Check if this move leaves our king in check
-                    bool exposesKing = board.isInCheck(game.isWhiteTurn());
-
-                    // Restore the board state
-                    board.setPiece(row, col, tempFrom);
-                    board.setPiece(r, c, tempTo);
-
-                    // Only add to valid moves if it doesn't expose the king
-                    if (!exposesKing) {
-                        //  capture our own piece check
-                        Piece* destPiece = board.getPiece(r, c);
-                        if (!destPiece || destPiece->isWhitePiece() != game.isWhiteTurn()) {
-                            validMoves.push_back(sf::Vector2i(c, r));
-                        }
-                    }
-                }
-            }
+        Bitboard targets = game.getLegalTargets(row, col);
+        while (targets) {
+            int square = popLsb(targets);
+            validMoves.push_back(sf::Vector2i(square % 8, square / 8));
         }
+        highlightsDirty = true;
     }
 }
 
 void ChessGUI::movePiece(int toRow, int toCol) {
     if (pieceSelected) {
+        if (!game.isLegalMove(selectedRow, selectedCol, toRow, toCol)) {
+            clearSelection();
+            return;
+        }
+
         Board& boardRef = game.getBoard();
         Piece* piece = boardRef.getPiece(selectedRow, selectedCol);
         Piece* capturedPiece = boardRef.getPiece(toRow, toCol);
@@ -350,19 +509,12 @@ void ChessGUI::movePiece(int toRow, int toCol) {
 
             if (isPawnMove || isCapture) {
                 fiftyMoveCounter = 0;  // Reset counter
-                // Also clear position history on irreversible moves
-                positionHistory.clear();
             }
             else {
                 fiftyMoveCounter++;
             }
-            moves++;
-
-            // FEN string creation
-            string fen = boardRef.generateFEN(game.isWhiteTurn(), boardRef.getWhiteCanCastleKingside(),
-                boardRef.getWhiteCanCastleQueenside(), boardRef.getBlackCanCastleKingside(), boardRef.getBlackCanCastleQueenside(), fiftyMoveCounter, moves);
-            // Store moves in the vectors
-            game.addMove(move, fen);
+            game.addMove({ selectedRow, selectedCol, toRow, toCol });
+            positionChanged();
             // Store current turn before toggling
             bool wasWhiteTurn = game.isWhiteTurn();
 
@@ -370,7 +522,7 @@ void ChessGUI::movePiece(int toRow, int toCol) {
             game.toggleTurn();
 
             // Update position history AFTER the move and turn toggle
-            updateDrawConditions();
+            updateDrawConditions(fiftyMoveCounter == 0);
 
             // Check for threefold repetition only after White's move
             // (i.e., when it's now Black's turn, meaning White just moved)
@@ -396,6 +548,7 @@ void ChessGUI::movePiece(int toRow, int toCol) {
             if (vsAI && game.isWhiteTurn() == aiIsWhite) {
                 aiThinking = true;
                 aiThinkTimer = sf::Time::Zero;
+                updateGameStatus();
                 // Don't call handleAIMove() immediately - let update() handle it with delay
             }
         }
@@ -408,11 +561,20 @@ void ChessGUI::movePiece(int toRow, int toCol) {
 
 
 
+// Called after every move and reset
+void ChessGUI::positionChanged() {
+    piecesDirty = true;
+    if (analysisMode) {
+        analysisGeneration = analysis.setPosition(game.getRecord());
+    }
+}
+
 void ChessGUI::clearSelection() {
     pieceSelected = false;
     selectedRow = -1;
     selectedCol = -1;
     validMoves.clear();
+    highlightsDirty = true;
 }
 
 void ChessGUI::handleAIMove() {
@@ -475,17 +637,13 @@ void ChessGUI::handleAIMove() {
             // IMPORTANT: Set the last move for en passant tracking
             boardRef.setLastMove(move);
             fiftyMoveCounter++;
-            moves++;
-            // FEN string creation
-            string fen = boardRef.generateFEN(game.isWhiteTurn(), boardRef.getWhiteCanCastleKingside(),
-                boardRef.getWhiteCanCastleQueenside(), boardRef.getBlackCanCastleKingside(), boardRef.getBlackCanCastleQueenside(), fiftyMoveCounter, moves);
-            // Store moves in the vectors
-            game.addMove(move, fen);
+            game.addMove({ fromRow, fromCol, toRow, toCol });
+            positionChanged();
             // Store current turn before toggling
             bool wasWhiteTurn = game.isWhiteTurn();
 
             game.toggleTurn();
-            updateDrawConditions(); // Add position after turn toggle
+            updateDrawConditions(false); // Add position after turn toggle
 
             // Check for threefold repetition only after White's move
             if (!wasWhiteTurn) { // White just moved
@@ -568,24 +726,17 @@ void ChessGUI::handleAIMove() {
 
         if (isPawnMove || isCapture) {
             fiftyMoveCounter = 0;  // Reset counter
-            // Also clear position history on irreversible moves
-            positionHistory.clear();
         }
         else {
             fiftyMoveCounter++;
         }
-        moves++;
-
-        // FEN string creation
-        string fen = boardRef.generateFEN(game.isWhiteTurn(), boardRef.getWhiteCanCastleKingside(),
-            boardRef.getWhiteCanCastleQueenside(), boardRef.getBlackCanCastleKingside(), boardRef.getBlackCanCastleQueenside(), fiftyMoveCounter, moves);
-        // Store moves in the vectors
-        game.addMove(move, fen);
+        game.addMove({ fromRow, fromCol, toRow, toCol });
+        positionChanged();
         // Store current turn before toggling
         bool wasWhiteTurn = game.isWhiteTurn();
 
         game.toggleTurn();
-        updateDrawConditions(); // Add position after turn toggle
+        updateDrawConditions(fiftyMoveCounter == 0); // Add position after turn toggle
 
         // Check for threefold repetition only after White's move
         if (!wasWhiteTurn) { // White just moved
@@ -604,71 +755,105 @@ void ChessGUI::handleAIMove() {
 }
 
 
-void ChessGUI::drawBoard() {
-    for (int row = 0; row < 8; row++) {
-        for (int col = 0; col < 8; col++) {
-            sf::RectangleShape square(sf::Vector2f(SQUARE_SIZE, SQUARE_SIZE));
-            square.setPosition(sf::Vector2f(BOARD_OFFSET_X + col * SQUARE_SIZE,
-                BOARD_OFFSET_Y + row * SQUARE_SIZE));
-
-            // Alternate colors
-            if ((row + col) % 2 == 0) {
-                square.setFillColor(getLightSquareColor());
-            }
-            else {
-                square.setFillColor(getDarkSquareColor());
-            }
-
-            window.draw(square);
-        }
+// Two triangles covering 'rect'; texture coordinates are in texels
+void ChessGUI::appendQuad(sf::VertexArray& vertices, sf::FloatRect rect, sf::Color color, sf::FloatRect textureRect) {
+    sf::Vector2f corners[4] = {
+        rect.position,
+        sf::Vector2f(rect.position.x + rect.size.x, rect.position.y),
+        rect.position + rect.size,
+        sf::Vector2f(rect.position.x, rect.position.y + rect.size.y)
+    };
+    sf::Vector2f texCoords[4] = {
+        textureRect.position,
+        sf::Vector2f(textureRect.position.x + textureRect.size.x, textureRect.position.y),
+        textureRect.position + textureRect.size,
+        sf::Vector2f(textureRect.position.x, textureRect.position.y + textureRect.size.y)
+    };
+    static const int ORDER[6] = { 0, 1, 2, 0, 2, 3 };
+    for (int i : ORDER) {
+        vertices.append(sf::Vertex{ corners[i], color, texCoords[i] });
     }
 }
 
-void ChessGUI::drawPieces() {
-    Board& board = game.getBoard(); // Reference, not copy!
+void ChessGUI::buildBoardVertices() {
+    boardVertices.clear();
+    coordinateVertices.clear();
 
     for (int row = 0; row < 8; row++) {
         for (int col = 0; col < 8; col++) {
-            Piece* piece = board.getPiece(row, col);
-            if (piece) {
-                std::string textureKey = getPieceTextureKey(piece);
-
-                if (pieceTextures.find(textureKey) != pieceTextures.end()) {
-                    sf::Sprite sprite(pieceTextures[textureKey]);
-
-                    // Scale the sprite to fit the square
-                    sf::Vector2u textureSize = pieceTextures[textureKey].getSize();
-                    float scaleX = (float)SQUARE_SIZE / textureSize.x;
-                    float scaleY = (float)SQUARE_SIZE / textureSize.y;
-                    sprite.setScale(sf::Vector2f(scaleX, scaleY));
-
-                    sprite.setPosition(sf::Vector2f(BOARD_OFFSET_X + col * SQUARE_SIZE,
-                        BOARD_OFFSET_Y + row * SQUARE_SIZE));
-
-                    window.draw(sprite);
-                }
+            bool light = (row + col) % 2 == 0;
+            sf::FloatRect square(sf::Vector2f(BOARD_OFFSET_X + col * SQUARE_SIZE, BOARD_OFFSET_Y + row * SQUARE_SIZE),
+                sf::Vector2f(SQUARE_SIZE, SQUARE_SIZE));
+            appendQuad(boardVertices, square, light ? getLightSquareColor() : getDarkSquareColor());
+
+            // Ranks in the top-left corner of the a-file, files in the bottom-right
+            // corner of the first rank, in the opposite square colour
+            char labels[2] = { 0, 0 };
+            if (col == 0) labels[0] = (char)('8' - row);
+            if (row == 7) labels[1] = (char)('a' + col);
+            for (int i = 0; i < 2; i++) {
+                if (!labels[i]) continue;
+                const sf::Glyph& glyph = font.getGlyph(labels[i], COORDINATE_SIZE, true);
+                sf::Vector2f origin = (i == 0)
+                    ? sf::Vector2f(square.position.x + 4, square.position.y + 4 + COORDINATE_SIZE)
+                    : sf::Vector2f(square.position.x + SQUARE_SIZE - 4 - glyph.advance, square.position.y + SQUARE_SIZE - 5);
+                sf::FloatRect textureRect(sf::Vector2f(glyph.textureRect.position), sf::Vector2f(glyph.textureRect.size));
+                appendQuad(coordinateVertices, sf::FloatRect(origin + glyph.bounds.position, glyph.bounds.size),
+                    light ? getDarkSquareColor() : getLightSquareColor(), textureRect);
             }
         }
     }
 }
 
-void ChessGUI::drawHighlights() {
+void ChessGUI::buildHighlightVertices() {
+    highlightVertices.clear();
+    sf::Vector2f squareSize(SQUARE_SIZE, SQUARE_SIZE);
+
     // Highlight selected square
     if (pieceSelected) {
-        highlightSquare.setPosition(sf::Vector2f(BOARD_OFFSET_X + selectedCol * SQUARE_SIZE,
-            BOARD_OFFSET_Y + selectedRow * SQUARE_SIZE));
-        window.draw(highlightSquare);
+        appendQuad(highlightVertices, sf::FloatRect(sf::Vector2f(BOARD_OFFSET_X + selectedCol * SQUARE_SIZE,
+            BOARD_OFFSET_Y + selectedRow * SQUARE_SIZE), squareSize), getHighlightColor());
     }
 
     // Highlight valid moves
-    sf::RectangleShape validMoveSquare(sf::Vector2f(SQUARE_SIZE, SQUARE_SIZE));
-    validMoveSquare.setFillColor(getValidMoveColor());
-
     for (const sf::Vector2i& move : validMoves) {
-        validMoveSquare.setPosition(sf::Vector2f(BOARD_OFFSET_X + move.x * SQUARE_SIZE,
-            BOARD_OFFSET_Y + move.y * SQUARE_SIZE));
-        window.draw(validMoveSquare);
+        appendQuad(highlightVertices, sf::FloatRect(sf::Vector2f(BOARD_OFFSET_X + move.x * SQUARE_SIZE,
+            BOARD_OFFSET_Y + move.y * SQUARE_SIZE), squareSize), getValidMoveColor());
+    }
+    highlightsDirty = false;
+}
+
+void ChessGUI::drawBoard() {
+    window.draw(boardVertices);
+    window.draw(coordinateVertices, &font.getTexture(COORDINATE_SIZE));
+}
+
+void ChessGUI::buildPieceVertices() {
+    Board& board = game.getBoard(); // Reference, not copy!
+    pieceVertices.clear();
+
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            int index = getPieceAtlasIndex(board.getPiece(row, col));
+            if (index < 0) continue;
+
+            // Each piece is stretched over its whole square
+            sf::FloatRect square(sf::Vector2f(BOARD_OFFSET_X + col * SQUARE_SIZE, BOARD_OFFSET_Y + row * SQUARE_SIZE),
+                sf::Vector2f(SQUARE_SIZE, SQUARE_SIZE));
+            appendQuad(pieceVertices, square, sf::Color::White, pieceRects[index]);
+        }
     }
+    piecesDirty = false;
+}
+
+void ChessGUI::drawPieces() {
+    if (piecesDirty) buildPieceVertices();
+    window.draw(pieceVertices, &pieceAtlas);
+}
+
+void ChessGUI::drawHighlights() {
+    if (highlightsDirty) buildHighlightVertices();
+    if (highlightVertices.getVertexCount() > 0) window.draw(highlightVertices);
 }
 
 void ChessGUI::drawUI() {
@@ -677,29 +862,21 @@ void ChessGUI::drawUI() {
     window.draw(newGameText);
     window.draw(modeButton);
     window.draw(modeText);
+    window.draw(analysisButton);
+    window.draw(analysisButtonText);
 
     // Draw status texts
     window.draw(statusText);
     window.draw(turnText);
 }
 
-std::string ChessGUI::getPieceTextureKey(Piece* piece) {
-    if (!piece) return "";
-
-    char symbol = piece->getSymbol();
-    std::string key;
-
-    if (piece->isWhitePiece()) {
-        key = "w";
-    }
-    else {
-        key = "b";
-    }
+// Cell of the piece in the atlas, -1 for an empty square
+int ChessGUI::getPieceAtlasIndex(Piece* piece) {
+    if (!piece) return -1;
 
-    // Convert piece symbol to lowercase
-    key += tolower(symbol);
-
-    return key;
+    const char* type = strchr(PIECE_ORDER, tolower(piece->getSymbol()));
+    if (!type) return -1;
+    return (piece->isWhitePiece() ? 0 : PIECE_TYPES) + (int)(type - PIECE_ORDER);
 }
 
 sf::Color ChessGUI::getLightSquareColor() {
@@ -718,8 +895,10 @@ sf::Color ChessGUI::getValidMoveColor() {
     return sf::Color(0, 255, 0, 64);     // Semi-transparent green
 }
 
+// Only reads the status cached by Game; call after the position or the AI state changes
 void ChessGUI::updateGameStatus() {
-    Board& board = game.getBoard();
+    GameStatus status = game.getStatus();
+    needsRedraw = true;
 
     // Update turn text - Show AI thinking status during AI turn
     if (aiThinking && vsAI && game.isWhiteTurn() == aiIsWhite) {
@@ -739,35 +918,34 @@ void ChessGUI::updateGameStatus() {
         }
     }
 
-    // Check for draws first
-    if (checkThreefoldRepetition()) {
+    if (status == GameStatus::ThreefoldRepetition) {
         statusText.setString("Draw by Threefold Repetition!");
         gameOver = true;
         return;
     }
 
-    if (checkFiftyMoveRule()) {
+    if (status == GameStatus::FiftyMoveRule) {
         statusText.setString("Draw by Fifty Move Rule!");
         gameOver = true;
         return;
     }
 
-    if (board.insufficientMaterialCheck()) {
+    if (status == GameStatus::InsufficientMaterial) {
         statusText.setString("Draw by Insufficient Material!");
         gameOver = true;
         return;
     }
 
-    // Check game state - FIXED: Check if CURRENT player is in checkmate
-    if (board.isCheckmate(game.isWhiteTurn())) {
+    // Status is for the player to move
+    if (status == GameStatus::Checkmate) {
         statusText.setString(game.isWhiteTurn() ? "Black Wins by Checkmate!" : "White Wins by Checkmate!");
         gameOver = true;
     }
-    else if (board.isStalemate(game.isWhiteTurn())) {
+    else if (status == GameStatus::Stalemate) {
         statusText.setString("Stalemate - Draw!");
         gameOver = true;
     }
-    else if (board.isInCheck(game.isWhiteTurn())) {
+    else if (status == GameStatus::Check) {
         statusText.setString(game.isWhiteTurn() ? "White in Check!" : "Black in Check!");
     }
     else if (!aiThinking) {  // Only show "Game in Progress" when AI is not thinking
@@ -788,7 +966,8 @@ void ChessGUI::resetGame() {
     aiThinking = false;  // Reset AI thinking state
     aiThinkTimer = sf::Time::Zero;
     validMoves.clear();
-    positionHistory.clear();      // Clear position history
+    highlightsDirty = true;
+    positionChanged();
     fiftyMoveCounter = 0;         // Reset fifty move counter
     updateGameStatus();
 
@@ -796,7 +975,115 @@ void ChessGUI::resetGame() {
     if (vsAI && aiIsWhite) {
         aiThinking = true;
         aiThinkTimer = sf::Time::Zero;
+        updateGameStatus();
+    }
+}
+
+void ChessGUI::toggleAnalysis() {
+    analysisMode = !analysisMode;
+    analysisButtonText.setString(analysisMode ? "Analysis: On" : "Analysis: Off");
+    if (analysisMode) {
+        analysisText.setString("Analysing...");
+        buildEvalBar(0, 0);
+        analysisGeneration = analysis.setPosition(game.getRecord());
+    }
+    else {
+        analysis.stop();
+    }
+    needsRedraw = true;
+}
+
+// Takes everything queued and shows the newest update of the current position
+bool ChessGUI::pollAnalysis() {
+    AnalysisUpdate update, latest;
+    bool found = false;
+    while (analysis.poll(update)) {
+        if (update.generation == analysisGeneration) {
+            latest = std::move(update);
+            found = true;
+        }
+    }
+    if (!found) return false;
+
+    char summary[96];
+    char score[16];
+    if (latest.mateIn != 0) {
+        snprintf(score, sizeof(score), "#%d", latest.mateIn);
+    }
+    else {
+        snprintf(score, sizeof(score), "%+.2f", latest.score / 100.0);
+    }
+    snprintf(summary, sizeof(summary), "Depth %d   %s   %lld kN/s\n", latest.depth, score, latest.nps / 1000);
+
+    // As much of the PV as fits beside the buttons, cut at a move
+    const size_t maxLength = 52;
+    std::string pv = latest.pv;
+    if (pv.size() > maxLength) {
+        size_t cut = pv.rfind(' ', maxLength);
+        pv = pv.substr(0, cut == std::string::npos ? maxLength : cut) + " ...";
+    }
+    analysisText.setString(summary + pv);
+    buildEvalBar(latest.score, latest.mateIn);
+    return true;
+}
+
+// White's share of the bar grows from the bottom, on a logistic curve of the score
+void ChessGUI::buildEvalBar(int score, int mateIn) {
+    float white;
+    if (mateIn != 0) {
+        white = mateIn > 0 ? 1.0f : 0.0f;
+    }
+    else {
+        white = 1.0f / (1.0f + std::pow(10.0f, -score / 400.0f));
+    }
+
+    const float x = 44, width = 24;
+    float split = BOARD_OFFSET_Y + BOARD_SIZE * (1.0f - white);
+    evalBarVertices.clear();
+    appendQuad(evalBarVertices, sf::FloatRect(sf::Vector2f(x, BOARD_OFFSET_Y), sf::Vector2f(width, split - BOARD_OFFSET_Y)),
+        sf::Color(30, 30, 30));
+    appendQuad(evalBarVertices, sf::FloatRect(sf::Vector2f(x, split), sf::Vector2f(width, BOARD_OFFSET_Y + BOARD_SIZE - split)),
+        sf::Color(235, 235, 235));
+}
+
+void ChessGUI::drawAnalysis() {
+    window.draw(evalBarVertices);
+    window.draw(analysisText);
+}
+
+// Stage times of the last frame and the average over the history, then a
+// histogram of frame times in 2 ms buckets (green within a 60 Hz frame)
+void ChessGUI::drawHud() {
+    char text[512];
+    int length = snprintf(text, sizeof(text), "%-11s %6s %6s\n", "ms", "last", "avg");
+    for (int s = 0; s < FrameProfiler::STAGE_COUNT; s++) {
+        FrameStage stage = (FrameStage)s;
+        length += snprintf(text + length, sizeof(text) - length, "%-11s %6.2f %6.2f\n",
+            FrameProfiler::getStageName(stage), profiler.getLast(stage), profiler.getAverage(stage));
+    }
+    snprintf(text + length, sizeof(text) - length, "%-11s %6.2f %6.2f\n%d frames, F12 saves CSV", "total",
+        profiler.getLastTotal(), profiler.getAverageTotal(), profiler.getFrameCount());
+    hudText.setString(text);
+
+    const float left = 560, top = 84, width = 230, height = 250;
+    const float barWidth = 12, barArea = 50, baseline = top + height - 10;
+    int buckets[FrameProfiler::HISTOGRAM_BUCKETS];
+    profiler.getHistogram(buckets);
+    int highest = 1;
+    for (int count : buckets) {
+        highest = std::max(highest, count);
+    }
+
+    hudVertices.clear();
+    appendQuad(hudVertices, sf::FloatRect(sf::Vector2f(left, top), sf::Vector2f(width, height)), sf::Color(0, 0, 0, 190));
+    for (int b = 0; b < FrameProfiler::HISTOGRAM_BUCKETS; b++) {
+        float barHeight = barArea * buckets[b] / highest;
+        bool withinFrame = (b + 1) * FrameProfiler::BUCKET_MS <= 1000.0f / 60;
+        appendQuad(hudVertices, sf::FloatRect(sf::Vector2f(left + 10 + b * barWidth, baseline - barHeight),
+            sf::Vector2f(barWidth - 2, barHeight)), withinFrame ? sf::Color(90, 200, 90) : sf::Color(220, 80, 60));
     }
+    window.draw(hudVertices);
+    window.draw(hudText);
 }
 
 void ChessGUI::toggleMode() {
@@ -2,16 +2,12 @@
 #include <SFML/Graphics.hpp>
 #include "Game.h"
 #include "Board.h"
-#include <unordered_map>
+#include "LiveAnalysis.h"
+#include "FrameProfiler.h"
 #include <string>
 
 class ChessGUI {
 private:
-    static sf::Font loadFont() {
-        sf::Font font;
-        font.openFromFile("arial.ttf"); // Just try to load, handle errors elsewhere
-        return font;
-    }
     sf::RenderWindow window;
     Game game;
     sf::Font font;
@@ -21,9 +17,18 @@ private:
     static const int SQUARE_SIZE = 80;
     static const int BOARD_OFFSET_X = 80;
     static const int BOARD_OFFSET_Y = 80;
+    static const unsigned COORDINATE_SIZE = 14;
+    static const unsigned DEFAULT_FRAME_LIMIT = 60;
 
-    // Piece textures
-    std::unordered_map<std::string, sf::Texture> pieceTextures;
+    // Piece textures, packed into one atlas: white pieces on the first row,
+    // black on the second, in PIECE_ORDER. All pieces are drawn from one
+    // vertex array that is rebuilt only when the position changes.
+    static const int PIECE_TYPES = 6;
+    static const int ATLAS_PADDING = 2;
+    sf::Texture pieceAtlas;
+    sf::FloatRect pieceRects[2 * PIECE_TYPES];  // texels of each piece in the atlas
+    sf::VertexArray pieceVertices;
+    bool piecesDirty;
 
     // Game state
     bool pieceSelected;
@@ -33,9 +38,16 @@ private:
     bool aiIsWhite;
 
     // Visual feedback
-    sf::RectangleShape highlightSquare;
     std::vector<sf::Vector2i> validMoves;
 
+    // Cached geometry, one draw call each: the squares, the coordinate
+    // labels (glyph quads on the font texture) and the selection overlays.
+    // The board is built once; highlights are rebuilt when the selection changes.
+    sf::VertexArray boardVertices;
+    sf::VertexArray coordinateVertices;
+    sf::VertexArray highlightVertices;
+    bool highlightsDirty;
+
     // UI Elements
     sf::Text statusText;
     sf::Text turnText;
@@ -43,9 +55,24 @@ private:
     sf::Text newGameText;
     sf::RectangleShape modeButton;
     sf::Text modeText;
+    sf::RectangleShape analysisButton;
+    sf::Text analysisButtonText;
+    sf::Text analysisText;                     // depth, score, speed and PV of the analysis
+
+    // Analysis mode: an endless search of the current position on a background
+    // thread, restarted on every move, shown as an evaluation bar beside the
+    // board. Updates are drained from the analysis queue without blocking.
+    LiveAnalysis analysis;
+    bool analysisMode;
+    unsigned analysisGeneration;               // updates for earlier positions are dropped
+    sf::VertexArray evalBarVertices;
 
-    // Move History
-    int moves;
+    // Frame profiling: CPU time of each stage of every rendered frame. F3
+    // shows it with a histogram of frame times; F12 writes it as CSV.
+    FrameProfiler profiler;
+    bool hudVisible;
+    sf::Text hudText;
+    sf::VertexArray hudVertices;
 
 public:
     ChessGUI(bool playVsAI = false, bool aiPlaysWhite = false);
@@ -53,17 +80,27 @@ public:
 
     bool initialize();
     void run();
+    // UI font from the asset pack, the asset folders or the system fonts
+    static bool loadFont(sf::Font& font);
+    // Frames per second while something animates (the AI's move delay); 0 = uncapped.
+    // An idle window only redraws after an event.
+    void setFrameLimit(unsigned fps) { frameLimit = fps; }
     bool checkThreefoldRepetition();
     bool checkFiftyMoveRule();
-    void updateDrawConditions();
+    void updateDrawConditions(bool irreversible);
 
 private:
     bool aiThinking;
     sf::Time aiThinkTimer;
-    std::vector<std::string> positionHistory;  // Track position history
+    bool needsRedraw;                          // something on screen changed since the last frame
+    unsigned frameLimit;
+    sf::Clock startupClock;                    // time to first frame, from window creation
+    bool firstFrameShown;
     int fiftyMoveCounter;                      // Track 50-move rule
     bool loadPieceTextures();
     void handleEvents();
+    void handleEvent(const sf::Event& event);
+    bool isIdle();
     void render();
     void update(sf::Time deltaTime);
     // Board interaction
@@ -72,18 +109,31 @@ private:
     void selectPiece(int row, int col);
     void movePiece(int toRow, int toCol);
     void clearSelection();
+    void positionChanged();
+
+    // Analysis mode
+    void toggleAnalysis();
+    bool pollAnalysis();
+    void buildEvalBar(int score, int mateIn);
 
     // AI handling
     void handleAIMove();
 
     // Drawing functions
+    void buildBoardVertices();
+    void buildHighlightVertices();
+    void buildPieceVertices();
+    static void appendQuad(sf::VertexArray& vertices, sf::FloatRect rect, sf::Color color,
+        sf::FloatRect textureRect = sf::FloatRect());
     void drawBoard();
     void drawPieces();
     void drawHighlights();
     void drawUI();
+    void drawAnalysis();
+    void drawHud();
 
     // Utility functions
-    std::string getPieceTextureKey(Piece* piece);
+    static int getPieceAtlasIndex(Piece* piece);
     sf::Color getLightSquareColor();
     sf::Color getDarkSquareColor();
     sf::Color getHighlightColor();
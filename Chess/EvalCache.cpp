@@ -0,0 +1,59 @@
+#include "EvalCache.h"
+
+EvalCache::EvalCache(size_t megabytes) {
+    resize(megabytes);
+}
+
+EvalCache::EvalCache(const EvalCache& other) {
+    resize(other.getSizeBytes() >> 20);
+}
+
+EvalCache& EvalCache::operator=(const EvalCache& other) {
+    if (this != &other) {
+        resize(other.getSizeBytes() >> 20);
+    }
+    return *this;
+}
+
+void EvalCache::resize(size_t megabytes) {
+    // Power of two slot count so the index is a mask of the key
+    size_t wanted = (megabytes << 20) / sizeof(Slot);
+    size_t count = 1;
+    while (count * 2 <= wanted) count *= 2;
+
+    slots.reset(new Slot[count]);
+    slotCount = count;
+    resetStats();
+}
+
+void EvalCache::clear() {
+    for (size_t i = 0; i < slotCount; ++i) {
+        slots[i].check.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+    resetStats();
+}
+
+void EvalCache::resetStats() {
+    probes.store(0, std::memory_order_relaxed);
+    hits.store(0, std::memory_order_relaxed);
+}
+
+bool EvalCache::probe(uint64_t key, int& score) {
+    probes.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[key & (slotCount - 1)];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key) return false;
+
+    hits.fetch_add(1, std::memory_order_relaxed);
+    score = (int)(int32_t)(uint32_t)data;
+    return true;
+}
+
+void EvalCache::store(uint64_t key, int score) {
+    Slot& slot = slots[key & (slotCount - 1)];
+    uint64_t data = (uint32_t)(int32_t)score;
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+}
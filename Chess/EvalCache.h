@@ -0,0 +1,38 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Small cache of static evaluations keyed by the position hash.
+// Each slot stores (key ^ data, data) in two atomics, so readers never take a
+// lock: a slot torn by a concurrent writer fails the key check and is treated
+// as a miss. The cache is sized on its own, independent of any search table.
+class EvalCache {
+private:
+    struct Slot {
+        std::atomic<uint64_t> check{ 0 };  // key ^ data
+        std::atomic<uint64_t> data{ 0 };
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t slotCount = 0;
+    std::atomic<uint64_t> probes{ 0 };
+    std::atomic<uint64_t> hits{ 0 };
+
+public:
+    explicit EvalCache(size_t megabytes = 2);
+    EvalCache(const EvalCache& other);             // copies the size, not the contents
+    EvalCache& operator=(const EvalCache& other);
+
+    void resize(size_t megabytes);
+    void clear();
+
+    bool probe(uint64_t key, int& score);
+    void store(uint64_t key, int score);
+
+    size_t getSizeBytes() const { return slotCount * sizeof(Slot); }
+    uint64_t getProbes() const { return probes.load(std::memory_order_relaxed); }
+    uint64_t getHits() const { return hits.load(std::memory_order_relaxed); }
+    void resetStats();
+};
@@ -0,0 +1,92 @@
+#include "FrameProfiler.h"
+#include "Trace.h"
+#include <cstdio>
+
+static float millisecondsBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<float, std::milli>(to - from).count();
+}
+
+void FrameProfiler::beginFrame() {
+    current = Frame();
+    frameStart = lastMark = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::mark(FrameStage stage) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    current.stageMs[(int)stage] += millisecondsBetween(lastMark, now);
+    TRACE_COMPLETE(getStageName(stage), lastMark, now);
+    lastMark = now;
+}
+
+void FrameProfiler::endFrame() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    current.totalMs = millisecondsBetween(frameStart, now);
+    TRACE_COMPLETE("frame", frameStart, now);
+    frames[next] = current;
+    next = (next + 1) % HISTORY;
+    if (count < HISTORY) count++;
+    frameNumber++;
+}
+
+const FrameProfiler::Frame& FrameProfiler::frameAt(int age) const {
+    return frames[(next - 1 - age + HISTORY) % HISTORY];
+}
+
+float FrameProfiler::getLast(FrameStage stage) const {
+    return count > 0 ? frameAt(0).stageMs[(int)stage] : 0.0f;
+}
+
+float FrameProfiler::getAverage(FrameStage stage) const {
+    float sum = 0.0f;
+    for (int i = 0; i < count; i++) {
+        sum += frameAt(i).stageMs[(int)stage];
+    }
+    return count > 0 ? sum / count : 0.0f;
+}
+
+float FrameProfiler::getLastTotal() const {
+    return count > 0 ? frameAt(0).totalMs : 0.0f;
+}
+
+float FrameProfiler::getAverageTotal() const {
+    float sum = 0.0f;
+    for (int i = 0; i < count; i++) {
+        sum += frameAt(i).totalMs;
+    }
+    return count > 0 ? sum / count : 0.0f;
+}
+
+void FrameProfiler::getHistogram(int buckets[HISTOGRAM_BUCKETS]) const {
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+        buckets[b] = 0;
+    }
+    for (int i = 0; i < count; i++) {
+        int bucket = (int)(frameAt(i).totalMs / BUCKET_MS);
+        buckets[bucket < HISTOGRAM_BUCKETS ? bucket : HISTOGRAM_BUCKETS - 1]++;
+    }
+}
+
+const char* FrameProfiler::getStageName(FrameStage stage) {
+    static const char* NAMES[STAGE_COUNT] = { "events", "update", "board", "highlights", "pieces", "ui", "hud", "display" };
+    return NAMES[(int)stage];
+}
+
+bool FrameProfiler::writeCsv(const std::string& path) const {
+    FILE* out = fopen(path.c_str(), "w");
+    if (!out) return false;
+
+    fprintf(out, "frame");
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        fprintf(out, ",%s_ms", getStageName((FrameStage)s));
+    }
+    fprintf(out, ",total_ms\n");
+    for (int age = count - 1; age >= 0; age--) {
+        const Frame& frame = frameAt(age);
+        fprintf(out, "%lld", frameNumber - 1 - age);
+        for (int s = 0; s < STAGE_COUNT; s++) {
+            fprintf(out, ",%.3f", frame.stageMs[s]);
+        }
+        fprintf(out, ",%.3f\n", frame.totalMs);
+    }
+    return fclose(out) == 0;
+}
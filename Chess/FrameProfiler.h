@@ -0,0 +1,60 @@
+#pragma once
+#include <chrono>
+#include <string>
+
+// Stages of one GUI frame, in the order they run
+enum class FrameStage {
+    Events,
+    Update,
+    Board,
+    Highlights,
+    Pieces,
+    Ui,
+    Hud,
+    Display,
+    Count
+};
+
+// CPU time of each stage over the last HISTORY rendered frames. mark()
+// charges the time since the previous mark to a stage, so the stages of a
+// frame add up to its total without nested timers.
+class FrameProfiler {
+public:
+    static const int HISTORY = 240;
+    static const int STAGE_COUNT = (int)FrameStage::Count;
+    static const int HISTOGRAM_BUCKETS = 16;
+    static constexpr float BUCKET_MS = 2.0f;  // the last bucket takes everything slower
+
+    void beginFrame();
+    void mark(FrameStage stage);
+    // Keeps the frame; frames that were not rendered are simply not ended
+    void endFrame();
+
+    int getFrameCount() const { return count; }
+    float getLast(FrameStage stage) const;
+    float getAverage(FrameStage stage) const;
+    float getLastTotal() const;
+    float getAverageTotal() const;
+    // Frame totals of the history by BUCKET_MS buckets
+    void getHistogram(int buckets[HISTOGRAM_BUCKETS]) const;
+
+    static const char* getStageName(FrameStage stage);
+    // One row per frame in the history, oldest first, times in milliseconds
+    bool writeCsv(const std::string& path) const;
+
+private:
+    struct Frame {
+        float stageMs[STAGE_COUNT];
+        float totalMs;
+    };
+
+    Frame frames[HISTORY] = {};
+    int next = 0;    // slot of the next finished frame
+    int count = 0;   // frames in the history
+    long long frameNumber = 0;
+    Frame current = {};
+    std::chrono::steady_clock::time_point frameStart;
+    std::chrono::steady_clock::time_point lastMark;
+
+    const Frame& frameAt(int age) const;  // 0 = the newest frame
+};
@@ -7,6 +7,12 @@
 #include "Knight.h"
 #include "Bishop.h"
 #include "Board.h"
+#include "Zobrist.h"
+#include "EvalWeights.h"
+#include "Tablebase.h"
+#include "OpeningBook.h"
+#include "Trace.h"
+#include "AllocationCounter.h"
 #include <iostream>
 #include <cctype>
 #include <limits>
@@ -16,107 +22,160 @@
 #include <vector>
 #include <algorithm>
 using namespace std;
-// Piece-square tables (from white's perspective)
-static const int pawnTable[8][8] = {
-    { 0,  0,  0,  0,  0,  0,  0,  0},
-    {50, 50, 50, 50, 50, 50, 50, 50},
-    {10, 10, 20, 30, 30, 20, 10, 10},
-    { 5,  5, 10, 25, 25, 10,  5,  5},
-    { 0,  0,  0, 20, 20,  0,  0,  0},
-    { 5, -5,-10,  0,  0,-10, -5,  5},
-    { 5, 10, 10,-20,-20, 10, 10,  5},
-    { 0,  0,  0,  0,  0,  0,  0,  0}
-};
 
-static const int knightTable[8][8] = {
-    {-50,-40,-30,-30,-30,-30,-40,-50},
-    {-40,-20,  0,  0,  0,  0,-20,-40},
-    {-30,  0, 10, 15, 15, 10,  0,-30},
-    {-30,  5, 15, 20, 20, 15,  5,-30},
-    {-30,  0, 15, 20, 20, 15,  0,-30},
-    {-30,  5, 10, 15, 15, 10,  5,-30},
-    {-40,-20,  0,  5,  5,  0,-20,-40},
-    {-50,-40,-30,-30,-30,-30,-40,-50}
+// Lookup by piece index (P, N, B, R, Q, K); rows are from White's side
+static const int (*const pieceSquareTables[6])[8] = {
+    pawnTable, knightTable, bishopTable, rookTable, queenTable, kingTable
 };
+static const int pieceValues[6] = { 100, 320, 330, 500, 900, 10000 };
 
-static const int bishopTable[8][8] = {
-    {-20,-10,-10,-10,-10,-10,-10,-20},
-    {-10,  0,  0,  0,  0,  0,  0,-10},
-    {-10,  0,  5, 10, 10,  5,  0,-10},
-    {-10,  5,  5, 10, 10,  5,  5,-10},
-    {-10,  0, 10, 10, 10, 10,  0,-10},
-    {-10, 10, 10, 10, 10, 10, 10,-10},
-    {-10,  5,  0,  0,  0,  0,  5,-10},
-    {-20,-10,-10,-10,-10,-10,-10,-20}
-};
+Game::Game() : whiteTurn(true), transposition(std::make_shared<TranspositionTable>()) {
+    std::srand(std::time(nullptr));
+    resetPositionHistory();
+}
 
-static const int rookTable[8][8] = {
-    { 0,  0,  0,  5,  5,  0,  0,  0},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    { 5, 10, 10, 10, 10, 10, 10,  5},
-    { 0,  0,  0,  0,  0,  0,  0,  0}
-};
+void Game::resetPositionHistory(int halfmoveClock) {
+    TRACE_INSTANT("history reset", positionKeys.size());
+    positionKeys.clear();
+    positionKeys.push_back(board.getHashKey(whiteTurn));
+    irreversibleIndex = 0;
+    startHalfmoveClock = halfmoveClock;
+    refreshStatus(whiteTurn);
+}
 
-static const int queenTable[8][8] = {
-    {-20,-10,-10, -5, -5,-10,-10,-20},
-    {-10,  0,  0,  0,  0,  0,  0,-10},
-    {-10,  0,  5,  5,  5,  5,  0,-10},
-    { -5,  0,  5,  5,  5,  5,  0, -5},
-    {  0,  0,  5,  5,  5,  5,  0, -5},
-    {-10,  5,  5,  5,  5,  5,  0,-10},
-    {-10,  0,  5,  0,  0,  0,  0,-10},
-    {-20,-10,-10, -5, -5,-10,-10,-20}
-};
+void Game::recordPosition(bool whiteToMove, bool irreversible) {
+    positionKeys.push_back(board.getHashKey(whiteToMove));
+    if (irreversible) irreversibleIndex = positionKeys.size() - 1;
+    refreshStatus(whiteToMove);
+}
 
-static const int kingTable[8][8] = {
-    {-30,-40,-40,-50,-50,-40,-40,-30},
-    {-30,-40,-40,-50,-50,-40,-40,-30},
-    {-30,-40,-40,-50,-50,-40,-40,-30},
-    {-30,-40,-40,-50,-50,-40,-40,-30},
-    {-20,-30,-30,-40,-40,-30,-30,-20},
-    {-10,-20,-20,-20,-20,-20,-20,-10},
-    { 20, 20,  0,  0,  0,  0, 20, 20},
-    { 20, 30, 10,  0,  0, 10, 30, 20}
-};
-Game::Game() : whiteTurn(true) {
-    std::srand(std::time(nullptr));
+void Game::setPosition(const Board& position, bool whiteToMove, int halfmoveClock) {
+    board = position;
+    whiteTurn = whiteToMove;
+    resetPositionHistory(halfmoveClock);
+    record.reset(board, whiteTurn, halfmoveClock);
+}
+
+// Allocations since a count read at the start of an operation, -1 without a counter
+static long long allocationsSince(long long start) {
+    return start < 0 ? -1 : AllocationCounter::read() - start;
 }
 
-void Game::printPGN(const std::vector<std::string>& pgnMoves) {
-    for (size_t i = 0; i < pgnMoves.size(); ++i) {
-        if (i % 2 == 0)
-            std::cout << (i / 2 + 1) << ". ";
-        std::cout << pgnMoves[i] << " ";
-        if (i % 2 == 1)
-            std::cout << "\n";
+bool Game::applyMove(const SimpleMove& m) {
+    long long allocationsAtStart = AllocationCounter::read();
+    Piece* piece = board.getPiece(m.fromRow, m.fromCol);
+    bool irreversible = board.getPiece(m.toRow, m.toCol) || (piece && toupper(piece->getSymbol()) == 'P');
+    if (!board.playMove(m.fromRow, m.fromCol, m.toRow, m.toCol, whiteTurn)) return false;
+    whiteTurn = !whiteTurn;
+    recordPosition(whiteTurn, irreversible);
+    record.addMove(m);
+    moveAllocations = allocationsSince(allocationsAtStart);
+    return true;
+}
+
+// One legal move sweep per played position. Everything the GUI and the
+// console loop need to know about the position is derived from it here.
+void Game::refreshStatus(bool whiteToMove) {
+    std::vector<SimpleMove> candidates;
+    generateMoves(board, whiteToMove, candidates, false);
+    legalMoves.clear();
+    std::fill(std::begin(legalTargets), std::end(legalTargets), 0);
+    for (const SimpleMove& m : candidates) {
+        Board copy = board;
+        if (copy.movePiece(m.fromRow, m.fromCol, m.toRow, m.toCol, whiteToMove)) {
+            legalMoves.push_back(m);
+            legalTargets[m.fromRow * 8 + m.fromCol] |= squareBit(m.toRow, m.toCol);
+        }
     }
 
-    std::cout << "\n";
+    bool inCheck = board.isInCheck(whiteToMove);
+    if (legalMoves.empty()) status = inCheck ? GameStatus::Checkmate : GameStatus::Stalemate;
+    else if (isThreefoldRepetition()) status = GameStatus::ThreefoldRepetition;
+    else if (getHalfmoveClock() >= 100) status = GameStatus::FiftyMoveRule;
+    else if (board.insufficientMaterialCheck()) status = GameStatus::InsufficientMaterial;
+    else status = inCheck ? GameStatus::Check : GameStatus::InProgress;
+}
+
+// Occurrences of the current position, counting itself. Only positions with
+// the same side to move can match, so every other key is skipped.
+int Game::countRepetitions() const {
+    if (positionKeys.empty()) return 0;
+    size_t current = positionKeys.size() - 1;
+    int count = 1;
+    for (size_t i = current; i >= irreversibleIndex + 2; ) {
+        i -= 2;
+        if (positionKeys[i] == positionKeys[current]) ++count;
+    }
+    return count;
+}
+
+bool Game::isRepetition() const {
+    size_t current = positionKeys.size() - 1;
+    for (size_t i = current; i >= irreversibleIndex + 2; ) {
+        i -= 2;
+        if (positionKeys[i] == positionKeys[current]) return true;
+    }
+    return false;
+}
+
+void Game::printPGN() {
+    std::cout << record.toPgn() << "\n";
 }
 
-void Game::printFEN(const vector<string>& fenMoves) {
+// FEN after every ply, rendered from the record
+void Game::printFEN() {
     cout << endl;
-    for (size_t i = 0; i < fenMoves.size(); ++i) {
-        cout << fenMoves[i] << endl;
+    char fen[Board::FEN_BUFFER_SIZE];
+    for (int ply = 1; ply <= record.getPlyCount(); ++ply) {
+        if (record.fenAt(ply, fen, sizeof(fen))) cout << fen << endl;
     }
     std::cout << "\n";
 }
 int Game::evaluateBoard(Board& b, bool aiIsWhite) {
+    // The evaluation does not depend on the side to move, so the cache keeps
+    // one score from White's point of view for both perspectives
+    uint64_t key = b.getHashKey(true);
+    int whiteScore;
+    if (evalCache.probe(key, whiteScore)) {
+        return aiIsWhite ? whiteScore : -whiteScore;
+    }
+
+    int score = evaluateUncached(b, aiIsWhite);
+    evalCache.store(key, aiIsWhite ? score : -score);
+    return score;
+}
+
+int Game::evaluateUncached(Board& b, bool aiIsWhite) {
     // Check for terminal positions first
-    if (b.isCheckmate(!aiIsWhite)) return 100000;  // AI wins
-    if (b.isCheckmate(aiIsWhite))  return -100000; // AI loses
+    if (b.isCheckmate(!aiIsWhite)) return MATE_SCORE;   // AI wins
+    if (b.isCheckmate(aiIsWhite))  return -MATE_SCORE;  // AI loses
     if (b.isStalemate(aiIsWhite) || b.isStalemate(!aiIsWhite)) return 0; // Draw
 
-    int score = 0;
-    int aiMobility = 0, oppMobility = 0;
-    int aiCenter = 0, oppCenter = 0;
-    int aiDev = 0, oppDev = 0;
-    bool aiCastled = false, oppCastled = false;
-    int aiKingSafety = 0, oppKingSafety = 0;
+    EvalFeatures features;
+    extractEvalFeatures(b, features, pawnHash);
+
+    // Material evaluation with piece-square tables
+    int score = features.material;
+    for (int i = 0; i < features.pstCount; ++i) {
+        const EvalFeatures::PstTerm& term = features.pst[i];
+        int pst = pieceSquareTables[term.piece][term.square / 8][term.square % 8];
+        score += term.white ? pst : -pst;
+    }
+
+    // Strategic bonuses
+    score += features.mobility * MOBILITY_WEIGHT;        // Mobility is important
+    score += features.center * CENTER_CONTROL_WEIGHT;    // Center control
+    score += features.development * DEVELOPMENT_WEIGHT;  // Development
+    score += features.castled * CASTLED_BONUS;           // Castling
+    score += features.check * CHECK_BONUS;               // Check
+    score += features.fixed;                             // King safety and pawn structure
+
+    return aiIsWhite ? score : -score;
+}
+
+void Game::extractEvalFeatures(Board& b, EvalFeatures& features, PawnHashTable& pawnHash) {
+    features = EvalFeatures();
+    int whiteKingRow = -1, whiteKingCol = -1, blackKingRow = -1, blackKingCol = -1;
 
     const int CenterSquares[4][2] = { {3, 3}, {3, 4}, {4, 3}, {4, 4} };
 
@@ -126,90 +185,79 @@ int Game::evaluateBoard(Board& b, bool aiIsWhite) {
             if (!piece) continue;
 
             bool isWhite = piece->isWhitePiece();
-            bool isAI = (isWhite == aiIsWhite);
+            int sign = isWhite ? 1 : -1;
             char symbol = toupper(piece->getSymbol());
+            int index = Zobrist::pieceIndex(symbol);
+            if (index < 0) continue;
+
+            // Material and the piece-square table entry to apply
+            features.material += sign * pieceValues[index];
+            if (features.pstCount < EvalFeatures::MAX_PST_TERMS) {
+                EvalFeatures::PstTerm& term = features.pst[features.pstCount++];
+                term.piece = (uint8_t)index;
+                term.square = (uint8_t)((isWhite ? row : 7 - row) * 8 + col);
+                term.white = isWhite;
+            }
 
-            // Material evaluation with piece-square tables
-            int base = 0, pst = 0;
-            switch (symbol) {
-            case 'P':
-                base = 100;
-                pst = isWhite ? pawnTable[row][col] : pawnTable[7 - row][col];
-                break;
-            case 'N':
-                base = 320;
-                pst = isWhite ? knightTable[row][col] : knightTable[7 - row][col];
-                break;
-            case 'B':
-                base = 330;
-                pst = isWhite ? bishopTable[row][col] : bishopTable[7 - row][col];
-                break;
-            case 'R':
-                base = 500;
-                pst = isWhite ? rookTable[row][col] : rookTable[7 - row][col];
-                break;
-            case 'Q':
-                base = 900;
-                pst = isWhite ? queenTable[row][col] : queenTable[7 - row][col];
-                break;
-            case 'K':
-                base = 10000;
-                pst = isWhite ? kingTable[row][col] : kingTable[7 - row][col];
+            if (symbol == 'K') {
+                if (isWhite) { whiteKingRow = row; whiteKingCol = col; }
+                else { blackKingRow = row; blackKingCol = col; }
                 // Check if king has castled
                 if ((row == 0 || row == 7) && (col == 2 || col == 6)) {
-                    isAI ? aiCastled = true : oppCastled = true;
+                    features.castled += sign;
                 }
                 // King safety - penalty for being in center early
                 if (row >= 2 && row <= 5 && col >= 2 && col <= 5) {
-                    isAI ? aiKingSafety -= 20 : oppKingSafety -= 20;
+                    features.fixed -= sign * 20;
                 }
-                break;
             }
 
-            int value = base + pst;
-            score += isAI ? value : -value;
-
             // Count mobility (valid moves)
-            int moveCount = 0;
             for (int r = 0; r < 8; r++) {
                 for (int c = 0; c < 8; c++) {
                     if (piece->isValidMove(row, col, r, c, &b)) {
-                        moveCount++;
+                        features.mobility += sign;
                         // Bonus for controlling center squares
                         for (const auto& sq : CenterSquares) {
                             if (r == sq[0] && c == sq[1]) {
-                                isAI ? aiCenter++ : oppCenter++;
+                                features.center += sign;
                             }
                         }
                     }
                 }
             }
-            isAI ? aiMobility += moveCount : oppMobility += moveCount;
 
             // Development bonus for pieces off back rank
             if (symbol != 'P' && symbol != 'K') {
                 if ((isWhite && row < 7) || (!isWhite && row > 0)) {
-                    isAI ? aiDev++ : oppDev++;
+                    features.development += sign;
                 }
             }
         }
     }
 
-    // Strategic bonuses
-    score += (aiMobility - oppMobility) * 2;        // Mobility is important
-    score += (aiCenter - oppCenter) * 15;           // Center control
-    score += (aiDev - oppDev) * 10;                 // Development
-    score += aiKingSafety - oppKingSafety;          // King safety
-
     // Check bonuses
-    if (b.isInCheck(!aiIsWhite)) score += 25;      // Opponent in check
-    if (b.isInCheck(aiIsWhite)) score -= 25;       // AI in check
-
-    // Castling bonuses
-    if (aiCastled) score += 50;
-    if (oppCastled) score -= 50;
-
-    return score;
+    if (b.isInCheck(false)) features.check++;  // Black in check
+    if (b.isInCheck(true)) features.check--;   // White in check
+
+    // Pawn structure and pawn shields, cached by pawn configuration (White's point of view)
+    PawnEntry& pawns = pawnHash.probe(b);
+    int pawnScore = pawns.score;
+    if (whiteKingRow >= 0) pawnScore += PawnHashTable::kingShield(pawns, true, whiteKingRow, whiteKingCol);
+    if (blackKingRow >= 0) pawnScore -= PawnHashTable::kingShield(pawns, false, blackKingRow, blackKingCol);
+
+    // Passed pawns whose stop square is empty are closer to promoting
+    for (int side = 0; side < 2; ++side) {
+        Bitboard passed = pawns.passedPawns[side];
+        while (passed) {
+            int square = popLsb(passed);
+            int stopRow = square / 8 + (side == 0 ? -1 : 1);
+            if (stopRow >= 0 && stopRow < 8 && !b.getPiece(stopRow, square % 8)) {
+                pawnScore += side == 0 ? 10 : -10;
+            }
+        }
+    }
+    features.fixed += pawnScore;
 }
 
 void Game::AmbiguityCheck(Board& board, bool isWhiteTurn, int fromRow, int fromCol, int toRow, int toCol)
@@ -246,133 +294,475 @@ void Game::AmbiguityCheck(Board& board, bool isWhiteTurn, int fromRow, int fromC
 }
 
 
+// Move ordering keys: winning and even captures first (by SEE), then quiet
+// moves, then captures that lose material, which keep their negative SEE
+static const int GOOD_CAPTURE_ORDER = 100000;
+// Near the leaves, captures losing more than this after all recaptures are skipped
+static const int SEE_PRUNE_MARGIN = 100;
+static const int QUIESCENCE_MAX_PLY = 6;
+// Tablebase wins rank below an actual mate and shorten with the distance to mate
+static const int TABLEBASE_WIN_SCORE = 90000;
+
+static bool isCaptureMove(Board& b, const SimpleMove& m) {
+    Piece* target = b.getPiece(m.toRow, m.toCol);
+    if (target) return true;
+    Piece* piece = b.getPiece(m.fromRow, m.fromCol);
+    return piece && toupper(piece->getSymbol()) == 'P' && m.fromCol != m.toCol;  // en passant
+}
+
+static bool isIrreversibleMove(Board& b, const SimpleMove& m) {
+    Piece* piece = b.getPiece(m.fromRow, m.fromCol);
+    return b.getPiece(m.toRow, m.toCol) || (piece && toupper(piece->getSymbol()) == 'P');
+}
+
+void Game::generateMoves(Board& b, bool white, std::vector<SimpleMove>& moves, bool capturesOnly) {
+    moves.clear();
+    for (int fromRow = 0; fromRow < 8; ++fromRow) {
+        for (int fromCol = 0; fromCol < 8; ++fromCol) {
+            Piece* piece = b.getPiece(fromRow, fromCol);
+            if (!piece || piece->isWhitePiece() != white) continue;
+            for (int toRow = 0; toRow < 8; ++toRow) {
+                for (int toCol = 0; toCol < 8; ++toCol) {
+                    if (toRow == fromRow && toCol == fromCol) continue;
+                    SimpleMove move = { fromRow, fromCol, toRow, toCol };
+                    if (capturesOnly && !isCaptureMove(b, move)) continue;
+                    if (piece->isValidMove(fromRow, fromCol, toRow, toCol, &b)) {
+                        moves.push_back(move);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Game::orderMoves(Board& b, std::vector<SimpleMove>& moves) {
+    for (SimpleMove& move : moves) {
+        if (isCaptureMove(b, move)) {
+            int see = b.staticExchange(move.fromRow, move.fromCol, move.toRow, move.toCol);
+            move.orderScore = see >= 0 ? GOOD_CAPTURE_ORDER + see : see;
+        }
+        else {
+            move.orderScore = 0;
+        }
+    }
+    std::stable_sort(moves.begin(), moves.end(), [](const SimpleMove& a, const SimpleMove& b) {
+        return a.orderScore > b.orderScore;
+    });
+}
+
 int Game::minimax(Board& b, int depth, int alpha, int beta, bool maximizing, bool aiIsWhite) {
     minimaxNodeCount++;
-    if (depth == 0 || b.isCheckmate(true) || b.isCheckmate(false)) {
+    if (minimaxNodeCount >= nextLimitCheck) {
+        nextLimitCheck = minimaxNodeCount + 1024;
+        if (searchLimitReached()) searchAborted = true;
+    }
+    if (searchAborted) return 0;
+
+    int ply = searchPly();
+    if (ply < MAX_SEARCH_PLY) pvLength[ply] = ply;
+
+    // Returning to a position already on the board or in this line is a draw:
+    // whoever could improve on it will deviate
+    if (isRepetition()) {
+        return 0;
+    }
+    if (b.isCheckmate(true) || b.isCheckmate(false)) {
         return evaluateBoard(b, aiIsWhite);
     }
 
-    if (maximizing) {
-        int maxEval = std::numeric_limits<int>::min();
-        for (int fromRow = 0; fromRow < 8; ++fromRow) {
-            for (int fromCol = 0; fromCol < 8; ++fromCol) {
-                Piece* piece = b.getPiece(fromRow, fromCol);
-                if (piece && piece->isWhitePiece() == aiIsWhite) {
-                    for (int toRow = 0; toRow < 8; ++toRow) {
-                        for (int toCol = 0; toCol < 8; ++toCol) {
-                            if (piece->isValidMove(fromRow, fromCol, toRow, toCol, &b)) {
-                                Board copy = b;
-                                if (copy.movePiece(fromRow, fromCol, toRow, toCol, aiIsWhite)) {
-                                    int eval = minimax(copy, depth - 1, alpha, beta, false, aiIsWhite);
-                                    maxEval = std::max(maxEval, eval);
-                                    alpha = std::max(alpha, eval);
-                                    if (beta <= alpha) return maxEval;
-                                }
-                            }
-                        }
-                    }
-                }
+    bool sideWhite = maximizing ? aiIsWhite : !aiIsWhite;
+    TablebaseResult tb;
+    if (Tablebase::isAvailable() && popCount(b.getOccupancy()) <= Tablebase::MAX_PIECES &&
+        Tablebase::probe(b, sideWhite, tb)) {
+        int score = tb.wdl == 0 ? 0 : tb.wdl * (TABLEBASE_WIN_SCORE - tb.distance);
+        return sideWhite == aiIsWhite ? score : -score;
+    }
+
+    if (depth == 0) {
+        return quiescence(b, alpha, beta, maximizing, aiIsWhite, 0);
+    }
+
+    // Table scores are from the side to move's point of view; the search is
+    // from the AI's. The key of this node is already on the history stack.
+    uint64_t key = positionKeys.back();
+    int sign = sideWhite == aiIsWhite ? 1 : -1;
+    TTEntry entry;
+    bool hit = transposition->probe(key, entry);
+    if (hit && entry.depth >= depth) {
+        int score = sign * entry.score;
+        TTBound bound = entry.bound;
+        if (sign < 0 && bound != TTBound::Exact) bound = bound == TTBound::Lower ? TTBound::Upper : TTBound::Lower;
+        if (bound == TTBound::Exact ||
+            (bound == TTBound::Lower && score >= beta) ||
+            (bound == TTBound::Upper && score <= alpha)) {
+            return score;
+        }
+    }
+
+    std::vector<SimpleMove> moves;
+    generateMoves(b, sideWhite, moves, false);
+    orderMoves(b, moves);
+    // The stored best move of this position goes first
+    if (hit && entry.move.fromRow >= 0) {
+        for (size_t i = 1; i < moves.size(); ++i) {
+            const SimpleMove& m = moves[i];
+            if (m.fromRow == entry.move.fromRow && m.fromCol == entry.move.fromCol &&
+                m.toRow == entry.move.toRow && m.toCol == entry.move.toCol) {
+                std::rotate(moves.begin(), moves.begin() + i, moves.begin() + i + 1);
+                break;
             }
         }
-        return maxEval;
+    }
+    bool inCheck = (depth == 1) && b.isInCheck(sideWhite);
+
+    int alphaOriginal = alpha, betaOriginal = beta;
+    int bestEval = maximizing ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max();
+    SimpleMove bestMove = { -1, -1, -1, -1 };
+    int searched = 0;
+    for (const SimpleMove& m : moves) {
+        // At the frontier, a clearly losing capture is not worth its subtree
+        if (depth == 1 && !inCheck && searched > 0 && m.orderScore < -SEE_PRUNE_MARGIN) {
+            continue;
+        }
+
+        bool irreversible = isIrreversibleMove(b, m);
+        Board copy = b;
+        if (!copy.movePiece(m.fromRow, m.fromCol, m.toRow, m.toCol, sideWhite)) continue;
+        ++searched;
+
+        size_t savedIrreversible = irreversibleIndex;
+        positionKeys.push_back(copy.getHashKey(!sideWhite));
+        if (irreversible) irreversibleIndex = positionKeys.size() - 1;
+        int eval = minimax(copy, depth - 1, alpha, beta, !maximizing, aiIsWhite);
+        positionKeys.pop_back();
+        irreversibleIndex = savedIrreversible;
+        if (searchAborted) return 0;
+
+        if (maximizing ? eval > bestEval : eval < bestEval) {
+            bestEval = eval;
+            bestMove = m;
+            updatePv(ply, m);
+        }
+        if (maximizing) {
+            alpha = std::max(alpha, eval);
+        }
+        else {
+            beta = std::min(beta, eval);
+        }
+        if (beta <= alpha) break;
+    }
+    // No legal move and not mated (checked above): stalemate
+    if (searched == 0) return 0;
+
+    TTBound bound = TTBound::Exact;
+    if (bestEval <= alphaOriginal) bound = TTBound::Upper;
+    else if (bestEval >= betaOriginal) bound = TTBound::Lower;
+    if (sign < 0 && bound != TTBound::Exact) bound = bound == TTBound::Lower ? TTBound::Upper : TTBound::Lower;
+    transposition->store(key, sign * bestEval, depth, bound, &bestMove);
+    return bestEval;
+}
+
+// Resolves captures at the leaves so the evaluation is not taken in the
+// middle of an exchange. Captures with a negative SEE are never searched.
+int Game::quiescence(Board& b, int alpha, int beta, bool maximizing, bool aiIsWhite, int ply) {
+    minimaxNodeCount++;
+    int standPat = evaluateBoard(b, aiIsWhite);
+    if (ply >= QUIESCENCE_MAX_PLY || std::abs(standPat) >= MATE_SCORE) {
+        return standPat;
+    }
+
+    if (maximizing) {
+        if (standPat >= beta) return standPat;
+        alpha = std::max(alpha, standPat);
     }
     else {
-        int minEval = std::numeric_limits<int>::max();
-        for (int fromRow = 0; fromRow < 8; ++fromRow) {
-            for (int fromCol = 0; fromCol < 8; ++fromCol) {
-                Piece* piece = b.getPiece(fromRow, fromCol);
-                if (piece && piece->isWhitePiece() != aiIsWhite) {
-                    for (int toRow = 0; toRow < 8; ++toRow) {
-                        for (int toCol = 0; toCol < 8; ++toCol) {
-                            if (piece->isValidMove(fromRow, fromCol, toRow, toCol, &b)) {
-                                Board copy = b;
-                                if (copy.movePiece(fromRow, fromCol, toRow, toCol, !aiIsWhite)) {
-                                    int eval = minimax(copy, depth - 1, alpha, beta, true, aiIsWhite);
-                                    minEval = std::min(minEval, eval);
-                                    beta = std::min(beta, eval);
-                                    if (beta <= alpha) return minEval;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+        if (standPat <= alpha) return standPat;
+        beta = std::min(beta, standPat);
+    }
+
+    bool sideWhite = maximizing ? aiIsWhite : !aiIsWhite;
+    std::vector<SimpleMove> captures;
+    generateMoves(b, sideWhite, captures, true);
+    orderMoves(b, captures);
+
+    int bestEval = standPat;
+    for (const SimpleMove& m : captures) {
+        if (m.orderScore < GOOD_CAPTURE_ORDER) break;  // the rest lose material
+
+        Board copy = b;
+        if (!copy.movePiece(m.fromRow, m.fromCol, m.toRow, m.toCol, sideWhite)) continue;
+
+        int eval = quiescence(copy, alpha, beta, !maximizing, aiIsWhite, ply + 1);
+        if (maximizing) {
+            bestEval = std::max(bestEval, eval);
+            alpha = std::max(alpha, eval);
         }
-        return minEval;
+        else {
+            bestEval = std::min(bestEval, eval);
+            beta = std::min(beta, eval);
+        }
+        if (beta <= alpha) break;
     }
+    return bestEval;
 }
 
-std::string Game::findBestMove(bool aiIsWhite) {
+bool Game::searchLimitReached() {
+    if (searchLimits.stop && searchLimits.stop->load(std::memory_order_relaxed)) return true;
+    if (searchLimits.nodes > 0 && minimaxNodeCount >= searchLimits.nodes) return true;
+    if (searchLimits.timeMs > 0) {
+        auto elapsed = std::chrono::steady_clock::now() - searchStart;
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() >= searchLimits.timeMs) return true;
+    }
+    return false;
+}
+
+// Distance from the search root, read off the key stack
+int Game::searchPly() const {
+    size_t top = positionKeys.size() - 1;
+    return top >= searchRootIndex ? (int)(top - searchRootIndex) : MAX_SEARCH_PLY;
+}
+
+// The move becomes the head of this ply's line, followed by the child's line
+void Game::updatePv(int ply, const SimpleMove& move) {
+    if (ply >= MAX_SEARCH_PLY - 1 || pvTable.empty()) return;
+    SimpleMove* line = &pvTable[ply * MAX_SEARCH_PLY];
+    const SimpleMove* child = &pvTable[(ply + 1) * MAX_SEARCH_PLY];
+    line[ply] = move;
+    int childLength = std::max(pvLength[ply + 1], ply + 1);
+    for (int i = ply + 1; i < childLength; ++i) line[i] = child[i];
+    pvLength[ply] = childLength;
+}
+
+// Table cutoffs end the collected line early; continue it with the stored
+// best moves as long as they are legal
+void Game::extendPvFromTable(bool aiIsWhite, std::vector<SimpleMove>& pv, int length) {
+    Board line = board;
+    bool white = aiIsWhite;
+    for (const SimpleMove& m : pv) {
+        line.playMove(m.fromRow, m.fromCol, m.toRow, m.toCol, white);
+        white = !white;
+    }
+    TTEntry entry;
+    while ((int)pv.size() < length && transposition->probe(line.getHashKey(white), entry) && entry.move.fromRow >= 0) {
+        const SimpleMove& m = entry.move;
+        Piece* piece = line.getPiece(m.fromRow, m.fromCol);
+        if (!piece || piece->isWhitePiece() != white || !piece->isValidMove(m.fromRow, m.fromCol, m.toRow, m.toCol, &line) ||
+            !line.playMove(m.fromRow, m.fromCol, m.toRow, m.toCol, white)) {
+            break;
+        }
+        pv.push_back(m);
+        white = !white;
+    }
+}
+
+std::string Game::moveToUci(const Board& board, const SimpleMove& move) {
+    std::string text = {
+        static_cast<char>('a' + move.fromCol),
+        static_cast<char>('1' + (7 - move.fromRow)),
+        static_cast<char>('a' + move.toCol),
+        static_cast<char>('1' + (7 - move.toRow))
+    };
+    Piece* piece = board.getPiece(move.fromRow, move.fromCol);
+    if (piece && toupper(piece->getSymbol()) == 'P' && (move.toRow == 0 || move.toRow == 7)) {
+        text += 'q';  // Board::movePiece always promotes to a queen
+    }
+    return text;
+}
+
+SearchResult Game::search(bool aiIsWhite, const SearchLimits& limits) {
+    TRACE_SCOPE_VALUE("search", limits.depth);
+    long long allocationsAtStart = AllocationCounter::read();
+    searchLimits = limits;
+    searchStart = std::chrono::steady_clock::now();
+    searchAborted = false;
     minimaxNodeCount = 0;
-    int bestScore = std::numeric_limits<int>::min();
-    std::string bestMove;
+    nextLimitCheck = 1024;
+    evalCache.resetStats();
+    if (pvTable.empty()) pvTable.resize(MAX_SEARCH_PLY * MAX_SEARCH_PLY);
+
+    // In a tablebase position the children are scored exactly, so the
+    // heuristic bonuses below would only pull the engine off the shortest mate
+    TablebaseResult rootTb;
+    bool rootInTablebase = Tablebase::isAvailable() && Tablebase::probe(board, aiIsWhite, rootTb);
+
+    // Positions set up directly on the board (tools, tests) start a fresh history
+    uint64_t rootKey = board.getHashKey(aiIsWhite);
+    if (positionKeys.empty() || positionKeys.back() != rootKey) {
+        TRACE_INSTANT("history reset", positionKeys.size());
+        positionKeys.assign(1, rootKey);
+        irreversibleIndex = 0;
+        startHalfmoveClock = 0;
+    }
+    searchRootIndex = positionKeys.size() - 1;
+
+    // Legal root moves with their fixed strategic bonuses
+    struct RootMove {
+        SimpleMove move;
+        int bonus;
+        int score;
+        bool irreversible;
+    };
+    std::vector<SimpleMove> candidates;
+    generateMoves(board, aiIsWhite, candidates, false);
+    std::vector<RootMove> rootMoves;
+    for (const SimpleMove& m : candidates) {
+        Board copy = board;
+        if (!copy.movePiece(m.fromRow, m.fromCol, m.toRow, m.toCol, aiIsWhite)) continue;
+
+        int bonus = 0;
+        if (!rootInTablebase) {
+            Piece* piece = board.getPiece(m.fromRow, m.fromCol);
+            if (dynamic_cast<King*>(piece) && abs(m.fromCol - m.toCol) == 2) {
+                bonus += 50; // Castling bonus
+            }
 
-    std::vector<std::pair<std::string, int>> moveScores; // For debugging
+            // Bonus for captures that do not lose material after recaptures
+            Piece* capturedPiece = board.getPiece(m.toRow, m.toCol);
+            if (capturedPiece && board.staticExchange(m.fromRow, m.fromCol, m.toRow, m.toCol) >= 0) {
+                bonus += 20; // Capture bonus
+            }
 
-    for (int fromRow = 0; fromRow < 8; ++fromRow) {
-        for (int fromCol = 0; fromCol < 8; ++fromCol) {
-            Piece* piece = board.getPiece(fromRow, fromCol);
-            if (piece && piece->isWhitePiece() == aiIsWhite) {
-                for (int toRow = 0; toRow < 8; ++toRow) {
-                    for (int toCol = 0; toCol < 8; ++toCol) {
-                        if (piece->isValidMove(fromRow, fromCol, toRow, toCol, &board)) {
-                            Board copy = board;
-                            if (copy.movePiece(fromRow, fromCol, toRow, toCol, aiIsWhite)) {
-                                int score = minimax(copy, 3, std::numeric_limits<int>::min(),
-                                    std::numeric_limits<int>::max(), false, aiIsWhite);
-
-                                // Add strategic bonuses
-                                if (dynamic_cast<King*>(piece) && abs(fromCol - toCol) == 2) {
-                                    score += 50; // Castling bonus
-                                }
-
-                                // Bonus for capturing pieces
-                                Piece* capturedPiece = board.getPiece(toRow, toCol);
-                                if (capturedPiece) {
-                                    score += 20; // Capture bonus
-                                }
-
-                                // Bonus for center control
-                                if ((toRow == 3 || toRow == 4) && (toCol == 3 || toCol == 4)) {
-                                    score += 10;
-                                }
-
-                                std::string moveNotation;
-
-                                // Handle castling
-                                if (dynamic_cast<King*>(piece) && abs(fromCol - toCol) == 2) {
-                                    moveNotation = (toCol > fromCol) ? "O-O" : "O-O-O";
-                                }
-                                else {
-                                    // Standard algebraic notation (lowercase, no spaces)
-                                    moveNotation = std::string{
-                                        static_cast<char>('a' + fromCol),
-                                        static_cast<char>('1' + (7 - fromRow)),
-                                        static_cast<char>('a' + toCol),
-                                        static_cast<char>('1' + (7 - toRow))
-                                    };
-                                }
-
-                                moveScores.push_back({ moveNotation, score });
-
-                                if (score > bestScore) {
-                                    bestScore = score;
-                                    bestMove = moveNotation;
-                                }
-                            }
-                        }
-                    }
-                }
+            // Bonus for center control
+            if ((m.toRow == 3 || m.toRow == 4) && (m.toCol == 3 || m.toCol == 4)) {
+                bonus += 10;
+            }
+        }
+        rootMoves.push_back({ m, bonus, 0, isIrreversibleMove(board, m) });
+    }
+
+    SearchResult result;
+    if (rootMoves.empty()) return result;
+    result.bestMove = rootMoves[0].move;
+    result.pv.assign(1, rootMoves[0].move);
+
+    int maxDepth = std::max(1, std::min(limits.depth, MAX_SEARCH_PLY - 1));
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        TRACE_SCOPE_VALUE("iteration", depth);
+        int bestScore = std::numeric_limits<int>::min();
+        int bestIndex = -1;
+        int bestSearchScore = 0;  // bestScore without the root bonus
+        std::vector<SimpleMove> bestPv;
+
+        for (size_t i = 0; i < rootMoves.size(); ++i) {
+            RootMove& rm = rootMoves[i];
+            const SimpleMove& m = rm.move;
+            TRACE_SCOPE_DETAIL("root move", i, moveToUci(board, m).c_str());
+            Board copy = board;
+            copy.movePiece(m.fromRow, m.fromCol, m.toRow, m.toCol, aiIsWhite);
+
+            size_t savedIrreversible = irreversibleIndex;
+            positionKeys.push_back(copy.getHashKey(!aiIsWhite));
+            if (rm.irreversible) irreversibleIndex = positionKeys.size() - 1;
+            // A move only matters if it beats the best so far once its bonus is added
+            int alpha = bestIndex < 0 ? std::numeric_limits<int>::min() : bestScore - rm.bonus;
+            int score = minimax(copy, depth - 1, alpha, std::numeric_limits<int>::max(), false, aiIsWhite);
+            positionKeys.pop_back();
+            irreversibleIndex = savedIrreversible;
+            if (searchAborted) break;
+
+            rm.score = score + rm.bonus;
+            if (rm.score > bestScore) {
+                bestScore = rm.score;
+                bestSearchScore = score;
+                bestIndex = (int)i;
+                bestPv.assign(1, m);
+                for (int p = 1; p < pvLength[1]; ++p) bestPv.push_back(pvTable[MAX_SEARCH_PLY + p]);
+            }
+        }
+
+        // An interrupted iteration is only used when nothing deeper exists yet
+        if (bestIndex >= 0 && (!searchAborted || result.depth == 0)) {
+            result.bestMove = rootMoves[bestIndex].move;
+            // The bonuses only choose between moves; a reported mate stays a mate
+            result.score = bestSearchScore;
+            result.pv = bestPv;
+            if (!searchAborted) result.depth = depth;
+            extendPvFromTable(aiIsWhite, result.pv, depth);
+            result.mateIn = 0;
+            if (std::abs(result.score) >= MATE_SCORE) {
+                // Mate scores carry no distance; the PV ends with the mating move
+                int moves = ((int)result.pv.size() + 1) / 2;
+                result.mateIn = result.score > 0 ? moves : -moves;
             }
         }
+        if (searchAborted) break;
+
+        if (iterationCallback) {
+            result.nodes = minimaxNodeCount;
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - searchStart).count();
+            result.allocations = allocationsSince(allocationsAtStart);
+            iterationCallback(result);
+        }
+
+        // Next iteration searches the best move first, then the rest by score
+        RootMove best = rootMoves[bestIndex];
+        rootMoves.erase(rootMoves.begin() + bestIndex);
+        std::stable_sort(rootMoves.begin(), rootMoves.end(), [](const RootMove& a, const RootMove& b) {
+            return a.score > b.score;
+        });
+        rootMoves.insert(rootMoves.begin(), best);
+    }
+
+    result.nodes = minimaxNodeCount;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - searchStart).count();
+    result.allocations = allocationsSince(allocationsAtStart);
+    return result;
+}
+
+std::string Game::findBestMove(bool aiIsWhite) {
+    // Book moves need no search at all
+    SimpleMove bookMove;
+    bool fromBook = OpeningBook::isAvailable() && OpeningBook::pickMove(board, aiIsWhite, bookMove);
+
+    SearchResult result;
+    if (fromBook) {
+        result.bestMove = bookMove;
+        minimaxNodeCount = 0;
+    }
+    else {
+        SearchLimits limits;
+        limits.depth = 4;  // the root move plus three plies of minimax
+        result = search(aiIsWhite, limits);
+    }
+
+    std::string bestMove;
+    if (result.bestMove.fromRow >= 0) {
+        const SimpleMove& m = result.bestMove;
+        Piece* piece = board.getPiece(m.fromRow, m.fromCol);
+        // Handle castling
+        if (dynamic_cast<King*>(piece) && abs(m.fromCol - m.toCol) == 2) {
+            bestMove = (m.toCol > m.fromCol) ? "O-O" : "O-O-O";
+        }
+        else {
+            // Standard algebraic notation (lowercase, no spaces)
+            bestMove = moveToUci(board, m).substr(0, 4);
+        }
     }
-    std::cout << "Bird played: " << bestMove << " (score: " << bestScore << ")" << std::endl;
+
+    if (fromBook) {
+        std::cout << "Bird played: " << bestMove << " (book)" << std::endl;
+        return bestMove;
+    }
+    std::cout << "Bird played: " << bestMove << " (score: " << result.score << ")" << std::endl;
     std::cout << "[Minimax Stats] Nodes evaluated: " << minimaxNodeCount << std::endl;
+    std::cout << "[Pawn Hash] Hits: " << pawnHash.getHits() << " / " << pawnHash.getProbes() << std::endl;
+    uint64_t evalProbes = evalCache.getProbes();
+    std::cout << "[Eval Cache] Hits: " << evalCache.getHits() << " / " << evalProbes
+        << " (" << (evalProbes ? 100.0 * evalCache.getHits() / evalProbes : 0.0) << "%)" << std::endl;
+    TablebaseResult rootTb;
+    if (Tablebase::isAvailable() && Tablebase::probe(board, aiIsWhite, rootTb)) {
+        std::cout << "[Tablebase] " << (rootTb.wdl > 0 ? "Win" : rootTb.wdl < 0 ? "Loss" : "Draw");
+        if (rootTb.wdl != 0) std::cout << " in " << rootTb.distance << " plies";
+        std::cout << std::endl;
+    }
 
     return bestMove;
 }
 
 void Game::start() {
+    Tablebase::init(Tablebase::DEFAULT_DIRECTORY);
+    if (OpeningBook::loadKeys("books/polyglot_random64.txt")) OpeningBook::open("books/book.bin");
+
     std::string mode;
     std::cout << "Choose mode (1 = Multiplayer, 2 = Vs AI): ";
     std::getline(std::cin, mode);
@@ -399,8 +789,8 @@ void Game::start() {
             std::cout << "bird plays: " << input << "\n";
             if (input.empty()) {
                 std::cout << "bird failed to produce a move.\n";
-                printPGN(pgnMoves);
-                printFEN(fenMoves);
+                printPGN();
+                printFEN();
                 break;
             }
         }
@@ -410,8 +800,8 @@ void Game::start() {
         }
 
         if (input == "exit") {
-            printPGN(pgnMoves);
-            printFEN(fenMoves);
+            printPGN();
+            printFEN();
             break;
         }
 
@@ -504,69 +894,54 @@ void Game::start() {
         if (!move.isCapture && !dynamic_cast<Pawn*>(moved)) ++turns;
         else turns = 0;
 
-        moveHistory.push_back(move);
-        pgnMoves.push_back(move.toPGN());
+        record.addMove({ fromRow, fromCol, toRow, toCol });
         board.setLastMove(move);
-        std::string current = board.getSimplePosition(whiteTurn);
-        int count = 0;
-        for (const auto& pos : previousPositions) {
-            if (pos == current) ++count;
-        }
-        if (count == 2) {
-            std::cout << "\nDraw by threefold repetition.\n";
-            printPGN(pgnMoves);
-            printFEN(fenMoves);
-            break;
-        }
+        recordPosition(!whiteTurn, turns == 0);
 
-        previousPositions.push_back(current);
-        if (turns == 100) {
-            std::cout << "\nDraw by 50-move rule.\n";
-            printPGN(pgnMoves);
-            printFEN(fenMoves);
-            break;
-        }
-
-        if (move.isCheckmate) {
+        if (status == GameStatus::Checkmate) {
             board.printBoard();
             std::cout << (whiteTurn ? "Black" : "White") << " is checkmated! "
                 << (whiteTurn ? "White" : "Black") << " wins!\n";
-            printPGN(pgnMoves);
-            printFEN(fenMoves);
+            printPGN();
+            printFEN();
             break;
         }
-        else if (board.isStalemate(!whiteTurn)) {
+        else if (status == GameStatus::Stalemate) {
             board.printBoard();
             std::cout << "Stalemate! The game is a draw.\n";
-            printPGN(pgnMoves);
-            printFEN(fenMoves);
+            printPGN();
+            printFEN();
+            break;
+        }
+        else if (status == GameStatus::ThreefoldRepetition) {
+            std::cout << "\nDraw by threefold repetition.\n";
+            printPGN();
+            printFEN();
             break;
         }
-        else if (board.insufficientMaterialCheck()) {
+        else if (status == GameStatus::FiftyMoveRule) {
+            std::cout << "\nDraw by 50-move rule.\n";
+            printPGN();
+            printFEN();
+            break;
+        }
+        else if (status == GameStatus::InsufficientMaterial) {
             cout << "Draw due to insufficient material";
-            printPGN(pgnMoves);
-            printFEN(fenMoves);
+            printPGN();
+            printFEN();
             break;
         }
-        else if (move.isCheck) {
+        else if (status == GameStatus::Check) {
             std::cout << (whiteTurn ? "Black" : "White") << " is in check!\n";
         }
 
         whiteTurn = !whiteTurn;
         string fen = board.generateFEN(whiteTurn, WhiteCastleKingside, WhiteCastleQueenside, BlackCastleKingside, BlackCastleQueenside, turns, moves);
         cout << endl << fen << endl;
-        fenMoves.push_back(fen);
     }
 }
 
-void Game::addMove(Move move,string FEN) {
-    moveHistory.push_back(move);
-    pgnMoves.push_back(move.toPGN());
-    fenMoves.push_back(FEN);
-    return;
-}
-
 void Game::printMoveHistory() {
-    printPGN(pgnMoves);
-    printFEN(fenMoves);
+    printPGN();
+    printFEN();
 }
\ No newline at end of file
@@ -1,32 +1,142 @@
+#pragma once
 #include <vector>
 #include "Board.h"
 #include "Moves.h"
+#include "PawnHash.h"
+#include "EvalCache.h"
+#include "TranspositionTable.h"
+#include "GameRecord.h"
 #include <string>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
 using namespace std;
+
+// Raw evaluation terms of one position, before the weights in EvalWeights.h
+// are applied. Counts are White minus Black. Shared by evaluateBoard and the
+// offline tuner so both see exactly the same features.
+struct EvalFeatures {
+    static const int MAX_PST_TERMS = 32;
+    struct PstTerm {
+        uint8_t piece;   // P, N, B, R, Q, K = 0..5
+        uint8_t square;  // row * 8 + col, rows seen from the piece owner's side
+        bool white;
+    };
+
+    int material = 0;
+    PstTerm pst[MAX_PST_TERMS];
+    int pstCount = 0;
+    int mobility = 0;
+    int center = 0;
+    int development = 0;
+    int castled = 0;
+    int check = 0;
+    int fixed = 0;       // untuned terms: king centralisation and pawn structure
+};
+
+// Score of a checkmate for the side that mates; no other score reaches it
+static const int MATE_SCORE = 100000;
+
+// Budget for Game::search; whichever limit is reached first ends it
+struct SearchLimits {
+    int depth = 4;                             // plies, counting the root move
+    int timeMs = 0;                            // 0 = no time limit
+    long long nodes = 0;                       // 0 = no node limit
+    const std::atomic<bool>* stop = nullptr;   // raised by another thread to abort
+};
+
+struct SearchResult {
+    SimpleMove bestMove = { -1, -1, -1, -1 };  // fromRow -1 when there is no legal move
+    int score = 0;                             // from the side to move's point of view, root bonuses excluded
+    int mateIn = 0;                            // moves to mate, negative when the side to move is mated; 0 = no mate
+    int depth = 0;                             // deepest completed iteration
+    long long nodes = 0;
+    double seconds = 0.0;
+    long long allocations = -1;                // heap allocations, -1 without an AllocationCounter
+    std::vector<SimpleMove> pv;
+};
+
+// Called by Game::search after every completed iteration
+typedef std::function<void(const SearchResult&)> SearchCallback;
+
+// Outcome of the position on the board, computed once per played move
+enum class GameStatus {
+    InProgress,
+    Check,
+    Checkmate,
+    Stalemate,
+    ThreefoldRepetition,
+    FiftyMoveRule,
+    InsufficientMaterial
+};
+
 class Game {
 private:
     Board board;
     bool whiteTurn;
-    void printPGN(const std::vector<std::string>& pgnMoves);
-    void printFEN(const vector<string>& fenMoves);
-    std::vector<Move> moveHistory;
-    std::vector<std::string> pgnMoves;
-    vector <string> fenMoves;
+    void printPGN();
+    void printFEN();
+    GameRecord record;  // moves of the game; PGN and FEN are rendered from it
     bool WhiteCastleKingside = true;
     bool WhiteCastleQueenside = true;
     bool BlackCastleKingside = true;
     bool BlackCastleQueenside = true;
     bool RankCheck = false;
     bool FileCheck = false;
-    vector<std::string> previousPositions;
-    int minimaxNodeCount = 0;
+    // Zobrist keys of every position since the start of the game; during a
+    // search the current line is pushed on top. Positions before the last
+    // capture or pawn move can never recur, so scans stop at irreversibleIndex.
+    std::vector<uint64_t> positionKeys;
+    size_t irreversibleIndex = 0;
+    int startHalfmoveClock = 0;  // clock of the first position, counted until an irreversible move
+    bool isRepetition() const;
+    // Legal moves and status of the played position, refreshed by recordPosition
+    std::vector<SimpleMove> legalMoves;
+    Bitboard legalTargets[64] = {};  // by origin square, row * 8 + col
+    GameStatus status = GameStatus::InProgress;
+    void refreshStatus(bool whiteToMove);
+    long long minimaxNodeCount = 0;
+    long long moveAllocations = -1;
+    // Search state: limits, abort flag and the triangular principal variation table
+    static const int MAX_SEARCH_PLY = 64;
+    SearchLimits searchLimits;
+    std::chrono::steady_clock::time_point searchStart;
+    long long nextLimitCheck = 0;
+    bool searchAborted = false;
+    size_t searchRootIndex = 0;
+    std::vector<SimpleMove> pvTable;  // MAX_SEARCH_PLY rows of MAX_SEARCH_PLY moves
+    int pvLength[MAX_SEARCH_PLY] = {};
+    bool searchLimitReached();
+    int searchPly() const;
+    void updatePv(int ply, const SimpleMove& move);
+    void extendPvFromTable(bool aiIsWhite, std::vector<SimpleMove>& pv, int length);
+    void generateMoves(Board& b, bool white, std::vector<SimpleMove>& moves, bool capturesOnly);
+    void orderMoves(Board& b, std::vector<SimpleMove>& moves);
+    int quiescence(Board& b, int alpha, int beta, bool maximizing, bool aiIsWhite, int ply);
+    PawnHashTable pawnHash;
+    EvalCache evalCache;
+    std::shared_ptr<TranspositionTable> transposition;
+    SearchCallback iterationCallback;
+    int evaluateUncached(Board& board, bool isWhitePerspective);
 
 public:
     Game();
     void start();
     string findBestMove(bool isAIWhite);
+    // Iterative deepening from the current board within the limits
+    SearchResult search(bool aiIsWhite, const SearchLimits& limits);
+    static std::string moveToUci(const Board& board, const SimpleMove& move);
     int minimax(Board& b, int depth, int alpha, int beta, bool maximizing, bool aiIsWhite);
     int evaluateBoard(Board& board, bool isWhitePerspective);
+    void setEvalCacheSize(size_t megabytes) { evalCache.resize(megabytes); }
+    // Threads searching the same game share one table (lazy SMP)
+    void setTranspositionTable(const std::shared_ptr<TranspositionTable>& table) { transposition = table; }
+    const std::shared_ptr<TranspositionTable>& getTranspositionTable() const { return transposition; }
+    void setHashSize(size_t megabytes) { transposition->resize(megabytes); }
+    void setIterationCallback(const SearchCallback& callback) { iterationCallback = callback; }
+    // Evaluation terms of a position; needs no engine state beyond a pawn table
+    static void extractEvalFeatures(Board& board, EvalFeatures& features, PawnHashTable& pawnHash);
     void AmbiguityCheck(Board& board, bool isWhite, int fromRow, int fromCol, int toRow, int toCol);
     bool isWhiteTurn() { return whiteTurn; }
     void toggleTurn() {
@@ -39,7 +149,31 @@ public:
     bool getFileCheck() { return FileCheck; }
     // Keep the const version for read-only access
     const Board& getBoard() const { return board; }
-    void addMove(Move move, string FEN);
+    void addMove(const SimpleMove& move) { record.addMove(move); }
+    const GameRecord& getRecord() const { return record; }
+
+    // Repetition history, shared with the GUI and seen by the search
+    void resetPositionHistory(int halfmoveClock = 0);
+    void recordPosition(bool whiteToMove, bool irreversible);
+    // Starts a new history from a position, or plays a move and records it
+    void setPosition(const Board& position, bool whiteToMove, int halfmoveClock = 0);
+    bool applyMove(const SimpleMove& move);
+    int countRepetitions() const;
+    bool isThreefoldRepetition() const { return countRepetitions() >= 3; }
+    int getHalfmoveClock() const {
+        return (int)(positionKeys.size() - 1 - irreversibleIndex) + (irreversibleIndex == 0 ? startHalfmoveClock : 0);
+    }
+    // Heap allocations of the last applyMove, status refresh included; -1 without an AllocationCounter
+    long long getMoveAllocations() const { return moveAllocations; }
+
+    // Cached status of the played position; no move generation on access
+    GameStatus getStatus() const { return status; }
+    bool isGameOver() const { return status != GameStatus::InProgress && status != GameStatus::Check; }
+    const std::vector<SimpleMove>& getLegalMoves() const { return legalMoves; }
+    Bitboard getLegalTargets(int row, int col) const { return legalTargets[row * 8 + col]; }
+    bool isLegalMove(int fromRow, int fromCol, int toRow, int toCol) const {
+        return (legalTargets[fromRow * 8 + fromCol] & squareBit(toRow, toCol)) != 0;
+    }
     void printMoveHistory();
 
 };
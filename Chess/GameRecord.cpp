@@ -0,0 +1,371 @@
+#include "GameRecord.h"
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+static const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+static const char NIBBLE_SYMBOLS[16] = { 0, 'P', 'N', 'B', 'R', 'Q', 'K', 0, 0, 'p', 'n', 'b', 'r', 'q', 'k', 0 };
+
+enum RecordFlags {
+    FLAG_CUSTOM_START = 1,
+    FLAG_EVALS = 2,
+    FLAG_CLOCKS = 4,
+    RESULT_SHIFT = 3
+};
+
+static void putVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+static bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static int nibbleOf(char symbol) {
+    for (int i = 1; i < 16; ++i)
+        if (NIBBLE_SYMBOLS[i] == symbol) return i;
+    return 0;
+}
+
+static void packPosition(const Board& board, bool whiteTurn, uint8_t* packed) {
+    for (int square = 0; square < 64; square += 2) {
+        Piece* first = board.getPiece(square / 8, square % 8);
+        Piece* second = board.getPiece(square / 8, square % 8 + 1);
+        packed[square / 2] = (uint8_t)((first ? nibbleOf(first->getSymbol()) : 0) |
+            (second ? nibbleOf(second->getSymbol()) : 0) << 4);
+    }
+    packed[32] = (uint8_t)((whiteTurn ? 1 : 0) | board.getCastlingRights() << 1);
+    const string& target = board.getEnPassantTarget();
+    packed[33] = (uint8_t)(target.size() == 2 ? target[0] - 'a' + 1 : 0);
+}
+
+GameRecord::GameRecord() {
+    Board initial;
+    reset(initial, true);
+}
+
+void GameRecord::reset(const Board& startBoard, bool whiteTurn, int halfmoveClock, int fullmoveNumber) {
+    packPosition(startBoard, whiteTurn, start);
+    startHalfmove = halfmoveClock;
+    startFullmove = fullmoveNumber;
+
+    // Packed once, thread-safely: Games are constructed on many threads at once
+    static const std::array<uint8_t, PACKED_START_SIZE> standard = []() {
+        std::array<uint8_t, PACKED_START_SIZE> packed;
+        Board initial;
+        packPosition(initial, true, packed.data());
+        return packed;
+    }();
+    standardStart = memcmp(start, standard.data(), PACKED_START_SIZE) == 0 && halfmoveClock == 0 && fullmoveNumber == 1;
+
+    moves.clear();
+    evals.clear();
+    clocks.clear();
+    result = PgnResult::Unknown;
+}
+
+void GameRecord::addMove(const SimpleMove& move, int eval, int clockMs) {
+    // The optional columns appear with their first value, padded for earlier plies
+    if (eval != NO_EVAL || !evals.empty()) {
+        evals.resize(moves.size(), (int16_t)NO_EVAL);
+        if (eval > 32767) eval = 32767;
+        if (eval < -32767 && eval != NO_EVAL) eval = -32767;
+        evals.push_back((int16_t)eval);
+    }
+    if (clockMs != NO_CLOCK || !clocks.empty()) {
+        clocks.resize(moves.size(), (int32_t)NO_CLOCK);
+        clocks.push_back(clockMs);
+    }
+    moves.push_back(encodeMove(move));
+}
+
+uint16_t GameRecord::encodeMove(const SimpleMove& move) {
+    return (uint16_t)((move.fromRow * 8 + move.fromCol) | (move.toRow * 8 + move.toCol) << 6);
+}
+
+SimpleMove GameRecord::decodeMove(uint16_t move) {
+    int from = move & 63, to = (move >> 6) & 63;
+    return { from / 8, from % 8, to / 8, to % 8 };
+}
+
+void GameRecord::encode(std::vector<uint8_t>& out) const {
+    uint8_t flags = (uint8_t)((int)result << RESULT_SHIFT);
+    if (!standardStart) flags |= FLAG_CUSTOM_START;
+    if (!evals.empty()) flags |= FLAG_EVALS;
+    if (!clocks.empty()) flags |= FLAG_CLOCKS;
+    out.push_back(flags);
+    putVarint(out, (uint32_t)moves.size());
+
+    if (!standardStart) {
+        out.insert(out.end(), start, start + PACKED_START_SIZE);
+        putVarint(out, (uint32_t)startHalfmove);
+        putVarint(out, (uint32_t)startFullmove);
+    }
+
+    size_t base = out.size();
+    out.resize(base + moves.size() * 2);
+    for (size_t i = 0; i < moves.size(); ++i) {
+        out[base + 2 * i] = (uint8_t)moves[i];
+        out[base + 2 * i + 1] = (uint8_t)(moves[i] >> 8);
+    }
+    for (int16_t eval : evals) {
+        out.push_back((uint8_t)eval);
+        out.push_back((uint8_t)((uint16_t)eval >> 8));
+    }
+    for (int32_t clock : clocks) putVarint(out, (uint32_t)(clock + 1));
+}
+
+bool GameRecord::decode(const uint8_t* data, size_t size, size_t* used) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    if (p >= end) return false;
+    uint8_t flags = *p++;
+    uint32_t plies;
+    if (!getVarint(p, end, plies) || plies > size) return false;
+
+    if (flags & FLAG_CUSTOM_START) {
+        if (end - p < PACKED_START_SIZE) return false;
+        memcpy(start, p, PACKED_START_SIZE);
+        p += PACKED_START_SIZE;
+        uint32_t halfmove, fullmove;
+        if (!getVarint(p, end, halfmove) || !getVarint(p, end, fullmove)) return false;
+        startHalfmove = (int)halfmove;
+        startFullmove = (int)fullmove;
+        standardStart = false;
+    }
+    else {
+        Board initial;
+        reset(initial, true);
+    }
+
+    size_t fixedBytes = (size_t)plies * ((flags & FLAG_EVALS) ? 4 : 2);
+    if ((size_t)(end - p) < fixedBytes) return false;
+    moves.resize(plies);
+    for (uint32_t i = 0; i < plies; ++i, p += 2) moves[i] = (uint16_t)(p[0] | p[1] << 8);
+    evals.clear();
+    if (flags & FLAG_EVALS) {
+        evals.resize(plies);
+        for (uint32_t i = 0; i < plies; ++i, p += 2) evals[i] = (int16_t)(uint16_t)(p[0] | p[1] << 8);
+    }
+    clocks.clear();
+    if (flags & FLAG_CLOCKS) {
+        clocks.resize(plies);
+        for (uint32_t i = 0; i < plies; ++i) {
+            uint32_t value;
+            if (!getVarint(p, end, value)) return false;
+            clocks[i] = (int32_t)value - 1;
+        }
+    }
+    result = (PgnResult)((flags >> RESULT_SHIFT) & 3);
+    if (used) *used = p - data;
+    return true;
+}
+
+// FEN of the start position, written from the packed form
+size_t GameRecord::startFen(char* buffer, size_t capacity) const {
+    if (standardStart) {
+        size_t length = strlen(START_FEN);
+        if (length + 1 > capacity) return 0;
+        memcpy(buffer, START_FEN, length + 1);
+        return length;
+    }
+
+    char text[Board::FEN_BUFFER_SIZE];
+    char* out = text;
+    for (int row = 0; row < 8; ++row) {
+        int empty = 0;
+        for (int col = 0; col < 8; ++col) {
+            int square = row * 8 + col;
+            char symbol = NIBBLE_SYMBOLS[(start[square / 2] >> (square % 2 * 4)) & 15];
+            if (!symbol) {
+                ++empty;
+                continue;
+            }
+            if (empty) *out++ = (char)('0' + empty);
+            empty = 0;
+            *out++ = symbol;
+        }
+        if (empty) *out++ = (char)('0' + empty);
+        if (row < 7) *out++ = '/';
+    }
+    *out++ = ' ';
+    *out++ = (start[32] & 1) ? 'w' : 'b';
+    *out++ = ' ';
+    int castling = start[32] >> 1;
+    if (castling & 1) *out++ = 'K';
+    if (castling & 2) *out++ = 'Q';
+    if (castling & 4) *out++ = 'k';
+    if (castling & 8) *out++ = 'q';
+    if (!castling) *out++ = '-';
+    *out++ = ' ';
+    if (start[33]) {
+        *out++ = (char)('a' + start[33] - 1);
+        *out++ = (start[32] & 1) ? '6' : '3';
+    }
+    else {
+        *out++ = '-';
+    }
+    int written = snprintf(out, text + sizeof(text) - out, " %d %d", startHalfmove, startFullmove);
+    size_t length = (out - text) + (written > 0 ? written : 0);
+    if (length + 1 > capacity) return 0;
+    memcpy(buffer, text, length + 1);
+    return length;
+}
+
+bool GameRecord::positionAt(int ply, Board& board, FenState& state) const {
+    char fen[Board::FEN_BUFFER_SIZE];
+    if (!startFen(fen, sizeof(fen)) || !board.loadFEN(fen, state)) return false;
+
+    for (int i = 0; i < ply && i < (int)moves.size(); ++i) {
+        SimpleMove m = decodeMove(moves[i]);
+        Piece* piece = board.getPiece(m.fromRow, m.fromCol);
+        if (!piece || piece->isWhitePiece() != state.whiteTurn) return false;
+        bool reset = toupper(piece->getSymbol()) == 'P' || board.getPiece(m.toRow, m.toCol);
+        if (!piece->isValidMove(m.fromRow, m.fromCol, m.toRow, m.toCol, &board) ||
+            !board.playMove(m.fromRow, m.fromCol, m.toRow, m.toCol, state.whiteTurn)) {
+            return false;
+        }
+        state.halfmoveClock = reset ? 0 : state.halfmoveClock + 1;
+        if (!state.whiteTurn) ++state.fullmoveNumber;
+        state.whiteTurn = !state.whiteTurn;
+    }
+    return true;
+}
+
+size_t GameRecord::fenAt(int ply, char* buffer, size_t capacity) const {
+    Board board;
+    FenState state;
+    if (!positionAt(ply, board, state)) return 0;
+    return board.writeFEN(buffer, capacity, state.whiteTurn, state.halfmoveClock, state.fullmoveNumber);
+}
+
+std::string GameRecord::toSan(const Board& board, bool whiteTurn, const SimpleMove& m) {
+    Piece* piece = board.getPiece(m.fromRow, m.fromCol);
+    if (!piece) return "";
+    char type = (char)toupper(piece->getSymbol());
+    std::string san;
+
+    if (type == 'K' && (m.toCol - m.fromCol == 2 || m.fromCol - m.toCol == 2)) {
+        san = m.toCol > m.fromCol ? "O-O" : "O-O-O";
+    }
+    else {
+        bool capture = board.getPiece(m.toRow, m.toCol) != nullptr || (type == 'P' && m.fromCol != m.toCol);
+        if (type != 'P') {
+            san += type;
+            // Other pieces of the same kind that can legally reach the square
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            for (int row = 0; row < 8; ++row) {
+                for (int col = 0; col < 8; ++col) {
+                    if (row == m.fromRow && col == m.fromCol) continue;
+                    Piece* other = board.getPiece(row, col);
+                    if (!other || other->getSymbol() != piece->getSymbol()) continue;
+                    if (!other->isValidMove(row, col, m.toRow, m.toCol, const_cast<Board*>(&board))) continue;
+                    Board copy = board;
+                    if (!copy.movePiece(row, col, m.toRow, m.toCol, whiteTurn)) continue;
+                    ambiguous = true;
+                    if (col == m.fromCol) sameFile = true;
+                    if (row == m.fromRow) sameRank = true;
+                }
+            }
+            if (ambiguous) {
+                if (!sameFile) san += (char)('a' + m.fromCol);
+                else if (!sameRank) san += (char)('8' - m.fromRow);
+                else {
+                    san += (char)('a' + m.fromCol);
+                    san += (char)('8' - m.fromRow);
+                }
+            }
+        }
+        else if (capture) {
+            san += (char)('a' + m.fromCol);
+        }
+        if (capture) san += 'x';
+        san += (char)('a' + m.toCol);
+        san += (char)('8' - m.toRow);
+        if (type == 'P' && (m.toRow == 0 || m.toRow == 7)) san += "=Q";
+    }
+
+    Board after = board;
+    if (!after.playMove(m.fromRow, m.fromCol, m.toRow, m.toCol, whiteTurn)) return san;
+    if (after.isCheckmate(!whiteTurn)) san += '#';
+    else if (after.isInCheck(!whiteTurn)) san += '+';
+    return san;
+}
+
+std::string GameRecord::toPgn() const {
+    std::string pgn;
+    char fen[Board::FEN_BUFFER_SIZE];
+    if (!standardStart && startFen(fen, sizeof(fen))) {
+        pgn += "[SetUp \"1\"]\n[FEN \"";
+        pgn += fen;
+        pgn += "\"]\n\n";
+    }
+
+    Board board;
+    FenState state;
+    if (!positionAt(0, board, state)) return pgn;
+
+    bool needNumber = true;  // after a comment, Black's move gets "N..."
+    size_t lineStart = pgn.size();
+    for (int ply = 0; ply < (int)moves.size(); ++ply) {
+        SimpleMove m = decodeMove(moves[ply]);
+        std::string token;
+        if (state.whiteTurn) token = std::to_string(state.fullmoveNumber) + ". ";
+        else if (needNumber) token = std::to_string(state.fullmoveNumber) + "... ";
+        token += toSan(board, state.whiteTurn, m);
+        needNumber = false;
+
+        int eval = getEval(ply), clock = getClock(ply);
+        if (eval != NO_EVAL || clock != NO_CLOCK) {
+            char comment[64];
+            char* out = comment;
+            out += sprintf(out, " {");
+            if (eval != NO_EVAL) {
+                // Stored from the mover's view; PGN evals are from White's
+                int white = state.whiteTurn ? eval : -eval;
+                out += sprintf(out, "[%%eval %.2f]", white / 100.0);
+            }
+            if (clock != NO_CLOCK) {
+                int seconds = clock / 1000;
+                out += sprintf(out, "%s[%%clk %d:%02d:%02d]", eval != NO_EVAL ? " " : "",
+                    seconds / 3600, seconds / 60 % 60, seconds % 60);
+            }
+            sprintf(out, "}");
+            token += comment;
+            needNumber = true;
+        }
+
+        if (pgn.size() - lineStart + token.size() > 79) {
+            pgn += '\n';
+            lineStart = pgn.size();
+        }
+        else if (pgn.size() > lineStart) {
+            pgn += ' ';
+        }
+        pgn += token;
+
+        Piece* piece = board.getPiece(m.fromRow, m.fromCol);
+        bool reset = piece && (toupper(piece->getSymbol()) == 'P' || board.getPiece(m.toRow, m.toCol));
+        if (!board.playMove(m.fromRow, m.fromCol, m.toRow, m.toCol, state.whiteTurn)) break;
+        state.halfmoveClock = reset ? 0 : state.halfmoveClock + 1;
+        if (!state.whiteTurn) ++state.fullmoveNumber;
+        state.whiteTurn = !state.whiteTurn;
+    }
+
+    static const char* RESULTS[4] = { "1-0", "0-1", "1/2-1/2", "*" };
+    pgn += pgn.size() > lineStart ? " " : "";
+    pgn += RESULTS[(int)result];
+    pgn += '\n';
+    return pgn;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "Board.h"
+#include "Moves.h"
+#include "PgnReader.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Compact record of a game: the start position and one 16-bit move per ply,
+// optionally with an evaluation and a clock reading per ply. PGN and FEN are
+// rendered from it on demand by replaying the moves.
+//
+// Binary form, little-endian, self-delimiting so records can be concatenated:
+//   flags (1 byte): bit 0 custom start, bit 1 evals, bit 2 clocks, bits 3-4 result
+//   ply count (varint)
+//   custom start only: 32 bytes of square nibbles (row 0 = rank 8), side and
+//     castling byte, en passant file + 1, halfmove clock and fullmove number (varints)
+//   moves: 2 bytes each, from square | to square << 6 (square = row * 8 + col)
+//   evals: 2 bytes each (centipawns, side to move's view; NO_EVAL when unknown)
+//   clocks: varint each (milliseconds + 1, 0 when unknown)
+// A game from the standard start position takes 2 bytes plus 2 per ply.
+class GameRecord {
+public:
+    static const int NO_EVAL = -32768;
+    static const int NO_CLOCK = -1;
+
+    GameRecord();
+
+    void reset(const Board& start, bool whiteTurn, int halfmoveClock = 0, int fullmoveNumber = 1);
+    void addMove(const SimpleMove& move, int eval = NO_EVAL, int clockMs = NO_CLOCK);
+    void setResult(PgnResult gameResult) { result = gameResult; }
+
+    int getPlyCount() const { return (int)moves.size(); }
+    SimpleMove getMove(int ply) const { return decodeMove(moves[ply]); }
+    int getEval(int ply) const { return evals.empty() ? NO_EVAL : evals[ply]; }
+    int getClock(int ply) const { return clocks.empty() ? NO_CLOCK : clocks[ply]; }
+    PgnResult getResult() const { return result; }
+    bool hasStandardStart() const { return standardStart; }
+
+    static uint16_t encodeMove(const SimpleMove& move);
+    static SimpleMove decodeMove(uint16_t move);
+
+    // Appends the binary form; decode reads one record and reports its length
+    void encode(std::vector<uint8_t>& out) const;
+    bool decode(const uint8_t* data, size_t size, size_t* used = nullptr);
+
+    // Position before 'ply' (0 = start); false if a recorded move is illegal
+    bool positionAt(int ply, Board& board, FenState& state) const;
+    size_t fenAt(int ply, char* buffer, size_t capacity) const;
+    std::string toPgn() const;
+
+    // Standard algebraic notation of a legal move in the given position
+    static std::string toSan(const Board& board, bool whiteTurn, const SimpleMove& move);
+
+private:
+    static const int PACKED_START_SIZE = 34;
+
+    uint8_t start[PACKED_START_SIZE];  // square nibbles, side/castling, en passant
+    bool standardStart = true;
+    int startHalfmove = 0;
+    int startFullmove = 1;
+    std::vector<uint16_t> moves;
+    std::vector<int16_t> evals;   // empty when no ply has an evaluation
+    std::vector<int32_t> clocks;  // empty when no ply has a clock reading
+    PgnResult result = PgnResult::Unknown;
+
+    size_t startFen(char* buffer, size_t capacity) const;
+};
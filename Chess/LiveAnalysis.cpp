@@ -0,0 +1,96 @@
+#include "LiveAnalysis.h"
+#include "Trace.h"
+#include <cstdlib>
+
+static const int MAX_ANALYSIS_DEPTH = 63;
+
+LiveAnalysis::~LiveAnalysis() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        quitting = true;
+        stopSearch = true;
+        stateChanged.notify_all();
+    }
+    if (worker.joinable()) worker.join();
+}
+
+unsigned LiveAnalysis::setPosition(const GameRecord& record) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    pending = record;
+    hasPending = true;
+    stopSearch = true;
+    ++generation;
+    if (!worker.joinable()) worker = std::thread(&LiveAnalysis::run, this);
+    stateChanged.notify_all();
+    return generation;
+}
+
+void LiveAnalysis::stop() {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    hasPending = false;
+    stopSearch = true;
+    ++generation;
+}
+
+void LiveAnalysis::run() {
+    TRACE_THREAD_NAME("analysis");
+    std::unique_lock<std::mutex> lock(stateMutex);
+    while (true) {
+        stateChanged.wait(lock, [this]() { return quitting || hasPending; });
+        if (quitting) return;
+
+        // Reset the flag under the lock, so a setPosition that follows still aborts this search
+        GameRecord record = pending;
+        unsigned searchGeneration = generation;
+        hasPending = false;
+        stopSearch = false;
+        lock.unlock();
+        analyse(record, searchGeneration);
+        lock.lock();
+    }
+}
+
+void LiveAnalysis::analyse(const GameRecord& record, unsigned searchGeneration) {
+    // Replay the game so repetitions count in the search
+    Board start;
+    FenState state;
+    if (!record.positionAt(0, start, state)) return;
+    engine.setPosition(start, state.whiteTurn, state.halfmoveClock);
+    for (int ply = 0; ply < record.getPlyCount(); ++ply) {
+        if (!engine.applyMove(record.getMove(ply))) return;
+    }
+    if (!record.positionAt(record.getPlyCount(), start, state)) return;
+    bool white = engine.isWhiteTurn();
+
+    engine.setIterationCallback([&](const SearchResult& result) {
+        AnalysisUpdate update;
+        update.generation = searchGeneration;
+        update.depth = result.depth;
+        update.score = white ? result.score : -result.score;
+        update.mateIn = white ? result.mateIn : -result.mateIn;
+        update.nodes = result.nodes;
+        update.nps = result.seconds > 0 ? (long long)(result.nodes / result.seconds) : 0;
+
+        Board board = engine.getBoard();
+        bool side = white;
+        int fullmove = state.fullmoveNumber;
+        for (size_t i = 0; i < result.pv.size(); ++i) {
+            const SimpleMove& m = result.pv[i];
+            if (!update.pv.empty()) update.pv += ' ';
+            if (side) update.pv += std::to_string(fullmove) + ". ";
+            else if (i == 0) update.pv += std::to_string(fullmove) + "... ";
+            update.pv += GameRecord::toSan(board, side, m);
+            if (!board.playMove(m.fromRow, m.fromCol, m.toRow, m.toCol, side)) break;
+            if (!side) ++fullmove;
+            side = !side;
+        }
+        // A full queue means the consumer is behind; it catches up on the next iteration
+        updates.push(std::move(update));
+    });
+
+    SearchLimits limits;
+    limits.depth = MAX_ANALYSIS_DEPTH;
+    limits.stop = &stopSearch;
+    engine.search(white, limits);
+    engine.setIterationCallback(SearchCallback());
+}
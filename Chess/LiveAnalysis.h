@@ -0,0 +1,59 @@
+#pragma once
+#include "Game.h"
+#include "GameRecord.h"
+#include "SpscQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// One completed iteration of the background search
+struct AnalysisUpdate {
+    unsigned generation = 0;  // position the update belongs to, from setPosition
+    int depth = 0;
+    int score = 0;            // centipawns from White's point of view
+    int mateIn = 0;           // moves to mate, negative when Black mates; 0 when not a mate score
+    long long nodes = 0;
+    long long nps = 0;
+    std::string pv;           // principal variation in SAN, with move numbers
+};
+
+// Infinite search on a background thread, restarted whenever the position
+// changes. The engine and its transposition table persist between
+// positions, so after a move the search picks up what it already knows.
+// Results come back through a lock-free queue; the consumer polls it and
+// never waits on the search thread.
+class LiveAnalysis {
+public:
+    LiveAnalysis() = default;
+    ~LiveAnalysis();
+    LiveAnalysis(const LiveAnalysis&) = delete;
+    LiveAnalysis& operator=(const LiveAnalysis&) = delete;
+
+    // Aborts the running search and analyses the final position of the
+    // record instead; returns the generation its updates will carry
+    unsigned setPosition(const GameRecord& record);
+    // Aborts the running search and leaves the thread idle
+    void stop();
+    // Next queued update, if any
+    bool poll(AnalysisUpdate& update) { return updates.pop(update); }
+
+private:
+    static const size_t QUEUE_CAPACITY = 256;
+
+    Game engine;
+    SpscQueue<AnalysisUpdate, QUEUE_CAPACITY> updates;
+    std::thread worker;
+    std::atomic<bool> stopSearch{ false };
+
+    std::mutex stateMutex;
+    std::condition_variable stateChanged;
+    GameRecord pending;
+    bool hasPending = false;
+    bool quitting = false;
+    unsigned generation = 0;
+
+    void run();
+    void analyse(const GameRecord& record, unsigned searchGeneration);
+};
@@ -3,6 +3,15 @@
 #include "Piece.h"
 using namespace std;
 
+// Board coordinates of a move, used by the search and the legal move lists
+struct SimpleMove {
+    int fromRow;
+    int fromCol;
+    int toRow;
+    int toCol;
+    int orderScore = 0;  // move ordering key, higher is searched first
+};
+
 struct Move {
     string player;
     string fromCoord;
@@ -0,0 +1,206 @@
+#include "OpeningBook.h"
+#include "Board.h"
+#include "MappedFile.h"
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+
+// Entry layout: key (8 bytes), move (2), weight (2), learn (4), all big-endian.
+// Move bits: 0-2 to file, 3-5 to rank, 6-8 from file, 9-11 from rank,
+// 12-14 promotion piece (0 none, 1 N, 2 B, 3 R, 4 Q). Ranks count from
+// White's side, so row = 7 - rank. Castling is written as king takes rook.
+static const size_t ENTRY_SIZE = 16;
+static const uint64_t START_POSITION_KEY = 0x463B96181691FC9CULL;  // from the specification
+
+// Offsets into the Random64 table
+static const int CASTLE_OFFSET = 768;
+static const int EN_PASSANT_OFFSET = 772;
+static const int TURN_OFFSET = 780;
+
+namespace {
+    struct BookState {
+        uint64_t random[OpeningBook::RANDOM_KEY_COUNT] = {};
+        bool keysLoaded = false;
+        MappedFile file;
+    };
+
+    BookState& bookState() {
+        static BookState instance;
+        return instance;
+    }
+
+    uint64_t readBigEndian(const unsigned char* p, int bytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i) value = (value << 8) | p[i];
+        return value;
+    }
+
+    // Polyglot piece kinds: black pawn 0, white pawn 1, black knight 2, ... white king 11
+    int polyglotKind(char symbol) {
+        int kind;
+        switch (toupper(symbol)) {
+        case 'P': kind = 0; break;
+        case 'N': kind = 2; break;
+        case 'B': kind = 4; break;
+        case 'R': kind = 6; break;
+        case 'Q': kind = 8; break;
+        case 'K': kind = 10; break;
+        default: return -1;
+        }
+        return isupper(symbol) ? kind + 1 : kind;
+    }
+
+    bool isPawn(const Board& board, int row, int col, bool white) {
+        Piece* piece = board.getPiece(row, col);
+        return piece && piece->getSymbol() == (white ? 'P' : 'p');
+    }
+}
+
+bool OpeningBook::loadKeys(const std::string& path) {
+    BookState& state = bookState();
+    state.keysLoaded = false;
+    std::ifstream in(path);
+    if (!in) return false;
+
+    // Hex numbers separated by anything: "0x9D39247E33776D41ULL," or plain hex
+    std::string token;
+    int count = 0;
+    char c;
+    auto flush = [&]() {
+        if (token.size() > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X')) token.erase(0, 2);
+        while (!token.empty() && (toupper(token.back()) == 'U' || toupper(token.back()) == 'L')) token.pop_back();
+        if (!token.empty() && count < RANDOM_KEY_COUNT) state.random[count++] = strtoull(token.c_str(), nullptr, 16);
+        token.clear();
+    };
+    while (in.get(c)) {
+        if (isalnum((unsigned char)c)) token += c;
+        else flush();
+    }
+    flush();
+    if (count != RANDOM_KEY_COUNT) return false;
+
+    state.keysLoaded = true;
+    Board start;
+    if (polyglotKey(start, true) != START_POSITION_KEY) {
+        state.keysLoaded = false;
+        return false;
+    }
+    return true;
+}
+
+bool OpeningBook::open(const std::string& path) {
+    MappedFile& file = bookState().file;
+    if (!file.open(path)) return false;
+    if (file.size() == 0 || file.size() % ENTRY_SIZE != 0) {
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+bool OpeningBook::isAvailable() {
+    const BookState& state = bookState();
+    return state.keysLoaded && state.file.isOpen();
+}
+
+uint64_t OpeningBook::polyglotKey(const Board& board, bool whiteTurn) {
+    const BookState& state = bookState();
+    if (!state.keysLoaded) return 0;
+
+    uint64_t key = 0;
+    for (int row = 0; row < 8; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            Piece* piece = board.getPiece(row, col);
+            if (!piece) continue;
+            int kind = polyglotKind(piece->getSymbol());
+            if (kind >= 0) key ^= state.random[64 * kind + 8 * (7 - row) + col];
+        }
+    }
+
+    if (board.getWhiteCanCastleKingside()) key ^= state.random[CASTLE_OFFSET + 0];
+    if (board.getWhiteCanCastleQueenside()) key ^= state.random[CASTLE_OFFSET + 1];
+    if (board.getBlackCanCastleKingside()) key ^= state.random[CASTLE_OFFSET + 2];
+    if (board.getBlackCanCastleQueenside()) key ^= state.random[CASTLE_OFFSET + 3];
+
+    // The en passant file only counts when a pawn can actually capture there
+    const std::string& target = board.getEnPassantTarget();
+    if (target.size() == 2) {
+        int col = target[0] - 'a';
+        int pawnRow = whiteTurn ? 3 : 4;  // row of the pawn that just moved two squares
+        if ((col > 0 && isPawn(board, pawnRow, col - 1, whiteTurn)) ||
+            (col < 7 && isPawn(board, pawnRow, col + 1, whiteTurn))) {
+            key ^= state.random[EN_PASSANT_OFFSET + col];
+        }
+    }
+
+    if (whiteTurn) key ^= state.random[TURN_OFFSET];
+    return key;
+}
+
+void OpeningBook::probe(const Board& board, bool whiteTurn, std::vector<BookMove>& moves) {
+    moves.clear();
+    if (!isAvailable()) return;
+    const MappedFile& file = bookState().file;
+    const unsigned char* data = file.data();
+    size_t count = file.size() / ENTRY_SIZE;
+    uint64_t key = polyglotKey(board, whiteTurn);
+
+    // First entry with this key
+    size_t low = 0, high = count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (readBigEndian(data + mid * ENTRY_SIZE, 8) < key) low = mid + 1;
+        else high = mid;
+    }
+
+    for (size_t i = low; i < count && readBigEndian(data + i * ENTRY_SIZE, 8) == key; ++i) {
+        const unsigned char* entry = data + i * ENTRY_SIZE;
+        int encoded = (int)readBigEndian(entry + 8, 2);
+        int weight = (int)readBigEndian(entry + 10, 2);
+        int promotion = (encoded >> 12) & 7;
+        if (promotion != 0 && promotion != 4) continue;  // Board::movePiece only promotes to a queen
+
+        SimpleMove move;
+        move.toCol = encoded & 7;
+        move.toRow = 7 - ((encoded >> 3) & 7);
+        move.fromCol = (encoded >> 6) & 7;
+        move.fromRow = 7 - ((encoded >> 9) & 7);
+
+        Piece* piece = board.getPiece(move.fromRow, move.fromCol);
+        if (!piece || piece->isWhitePiece() != whiteTurn) continue;
+        if (toupper(piece->getSymbol()) == 'K' && move.fromCol == 4 && move.fromRow == move.toRow &&
+            (move.toCol == 7 || move.toCol == 0)) {
+            move.toCol = move.toCol == 7 ? 6 : 2;  // king takes rook -> king two squares
+        }
+
+        // Books built from other engines' games may hold moves this board rejects
+        Board copy = board;
+        if (!copy.movePiece(move.fromRow, move.fromCol, move.toRow, move.toCol, whiteTurn)) continue;
+        moves.push_back({ move, weight });
+    }
+}
+
+bool OpeningBook::pickMove(const Board& board, bool whiteTurn, SimpleMove& move) {
+    std::vector<BookMove> moves;
+    probe(board, whiteTurn, moves);
+    long long total = 0;
+    for (const BookMove& m : moves) total += m.weight;
+    if (moves.empty()) return false;
+
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    if (total == 0) {
+        move = moves[rng() % moves.size()].move;
+        return true;
+    }
+    long long pick = (long long)(rng() % (uint64_t)total);
+    for (const BookMove& m : moves) {
+        if (pick < m.weight) {
+            move = m.move;
+            return true;
+        }
+        pick -= m.weight;
+    }
+    move = moves.back().move;
+    return true;
+}
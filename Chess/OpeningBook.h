@@ -0,0 +1,36 @@
+#pragma once
+#include "Moves.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Board;
+
+struct BookMove {
+    SimpleMove move;
+    int weight;
+};
+
+// Polyglot opening book (.bin), memory-mapped and searched in place.
+// Entries are 16 bytes, big-endian, sorted by the Polyglot position key, so
+// a lookup is a binary search over the mapping with no loading step.
+//
+// Polyglot keys use the 781 fixed Random64 numbers from the Polyglot format
+// specification, which are read from a text file by loadKeys (hex values in
+// table order; the C array from the specification can be used as is). The
+// table is checked against the documented key of the start position.
+class OpeningBook {
+public:
+    static const int RANDOM_KEY_COUNT = 781;
+
+    static bool loadKeys(const std::string& path);
+    static bool open(const std::string& path);
+    static bool isAvailable();
+
+    static uint64_t polyglotKey(const Board& board, bool whiteTurn);
+
+    // Legal book moves of the position with their weights; empty when out of book
+    static void probe(const Board& board, bool whiteTurn, std::vector<BookMove>& moves);
+    // Picks a book move at random in proportion to its weight
+    static bool pickMove(const Board& board, bool whiteTurn, SimpleMove& move);
+};
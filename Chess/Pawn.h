@@ -7,4 +7,5 @@ public:
     bool isValidMove(int fromRow, int fromCol, int toRow, int toCol, Board* board) override;
     char getSymbol() const override;
     Piece* clone() const override { return new Pawn(isWhite); }  // For example
+    Piece* cloneInto(void* memory) const override { return new (memory) Pawn(isWhite); }
 };
@@ -0,0 +1,120 @@
+#include "PawnHash.h"
+#include "Board.h"
+#include <cctype>
+
+// Pawn structure weights (centipawns)
+static const int DOUBLED_PAWN_PENALTY = 15;
+static const int ISOLATED_PAWN_PENALTY = 12;
+static const int BACKWARD_PAWN_PENALTY = 8;
+static const int passedPawnBonus[8] = { 0, 10, 15, 25, 40, 60, 90, 0 };  // by rank, from the pawn's own side
+static const int SHIELD_CLOSE_BONUS = 10;  // shield pawn directly in front of the king
+static const int SHIELD_FAR_BONUS = 5;     // shield pawn two squares in front
+
+PawnHashTable::PawnHashTable(size_t entryCount) {
+    size_t size = 1;
+    while (size * 2 <= entryCount) size *= 2;
+    entries.resize(size);
+}
+
+void PawnHashTable::clear() {
+    for (PawnEntry& entry : entries) entry = PawnEntry();
+    probes = 0;
+    hits = 0;
+}
+
+PawnEntry& PawnHashTable::probe(const Board& board) {
+    uint64_t key = board.getPawnKey();
+    PawnEntry& entry = entries[key & (entries.size() - 1)];
+    ++probes;
+    if (entry.valid && entry.key == key) {
+        ++hits;
+        return entry;
+    }
+
+    entry = PawnEntry();
+    entry.key = key;
+    entry.valid = true;
+    evaluate(board, entry);
+    return entry;
+}
+
+void PawnHashTable::evaluate(const Board& board, PawnEntry& entry) {
+    for (int row = 1; row < 7; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            Piece* piece = board.getPiece(row, col);
+            if (piece && toupper(piece->getSymbol()) == 'P')
+                entry.pawns[piece->isWhitePiece() ? 0 : 1] |= squareBit(row, col);
+        }
+    }
+
+    int score[2] = { 0, 0 };
+    for (int side = 0; side < 2; ++side) {
+        bool white = (side == 0);
+        Bitboard own = entry.pawns[side];
+        Bitboard enemy = entry.pawns[1 - side];
+
+        // Doubled pawns: every pawn beyond the first on a file
+        for (int col = 0; col < 8; ++col) {
+            int count = popCount(own & fileMask(col));
+            if (count > 1) score[side] -= (count - 1) * DOUBLED_PAWN_PENALTY;
+        }
+
+        Bitboard remaining = own;
+        while (remaining) {
+            int square = popLsb(remaining);
+            int row = square / 8, col = square % 8;
+            Bitboard ahead = white ? rowsAbove(row) : rowsBelow(row);
+            Bitboard spanMask = fileMask(col) | adjacentFilesMask(col);
+
+            // Passed: no enemy pawn can stop or capture it, and no own pawn in front of it
+            if (!(enemy & spanMask & ahead) && !(own & fileMask(col) & ahead)) {
+                entry.passedPawns[side] |= squareBit(row, col);
+                score[side] += passedPawnBonus[white ? 7 - row : row];
+            }
+
+            // Isolated: no own pawns on neighbouring files
+            if (!(own & adjacentFilesMask(col))) {
+                score[side] -= ISOLATED_PAWN_PENALTY;
+                continue;
+            }
+
+            // Backward: no own pawn beside or behind it, and the stop square is covered by an enemy pawn
+            Bitboard supportRows = white ? rowsBelow(row - 1) : rowsAbove(row + 1);
+            if (!(own & adjacentFilesMask(col) & supportRows)) {
+                int attackerRow = white ? row - 2 : row + 2;
+                if (attackerRow >= 0 && attackerRow < 8 &&
+                    (enemy & adjacentFilesMask(col) & (0xFFULL << (attackerRow * 8)))) {
+                    score[side] -= BACKWARD_PAWN_PENALTY;
+                }
+            }
+        }
+    }
+
+    entry.score = score[0] - score[1];
+}
+
+int PawnHashTable::kingShield(PawnEntry& entry, bool white, int kingRow, int kingCol) {
+    int side = white ? 0 : 1;
+    int square = kingRow * 8 + kingCol;
+    if (entry.shieldSquare[side] == square) return entry.shieldScore[side];
+
+    int shield = 0;
+    // Only a king still on its first two ranks is sheltered by pawns
+    bool sheltered = white ? kingRow >= 6 : kingRow <= 1;
+    if (sheltered) {
+        int forward = white ? -1 : 1;
+        for (int col = kingCol - 1; col <= kingCol + 1; ++col) {
+            if (col < 0 || col > 7) continue;
+            int closeRow = kingRow + forward;
+            int farRow = kingRow + 2 * forward;
+            if (entry.pawns[side] & squareBit(closeRow, col))
+                shield += SHIELD_CLOSE_BONUS;
+            else if (farRow >= 0 && farRow < 8 && (entry.pawns[side] & squareBit(farRow, col)))
+                shield += SHIELD_FAR_BONUS;
+        }
+    }
+
+    entry.shieldSquare[side] = square;
+    entry.shieldScore[side] = shield;
+    return shield;
+}
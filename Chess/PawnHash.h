@@ -0,0 +1,43 @@
+#pragma once
+#include "Bitboard.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Board;
+
+// Cached pawn-structure evaluation for one pawn configuration.
+// Scores are from White's point of view.
+struct PawnEntry {
+    uint64_t key = 0;
+    bool valid = false;
+    int score = 0;                     // doubled, isolated, backward and passed pawns
+    Bitboard pawns[2] = { 0, 0 };      // [0] = white, [1] = black
+    Bitboard passedPawns[2] = { 0, 0 };
+
+    // King shield is cached for the last king square seen with this pawn structure
+    int shieldSquare[2] = { -1, -1 };
+    int shieldScore[2] = { 0, 0 };
+};
+
+class PawnHashTable {
+private:
+    std::vector<PawnEntry> entries;
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+    static void evaluate(const Board& board, PawnEntry& entry);
+
+public:
+    explicit PawnHashTable(size_t entryCount = 16384);  // rounded down to a power of two
+
+    // Returns the entry for the board's pawn structure, computing it on a miss
+    PawnEntry& probe(const Board& board);
+
+    // Pawn shield bonus in front of a king, cached in the entry per king square
+    static int kingShield(PawnEntry& entry, bool white, int kingRow, int kingCol);
+
+    void clear();
+    uint64_t getProbes() const { return probes; }
+    uint64_t getHits() const { return hits; }
+};
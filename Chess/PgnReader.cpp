@@ -0,0 +1,293 @@
+#include "PgnReader.h"
+#include <cstring>
+
+static const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+static inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+const PgnTag* PgnGame::findTag(const char* name) const {
+    size_t length = strlen(name);
+    for (const PgnTag& tag : tags) {
+        if (tag.nameLength == length && memcmp(tag.name, name, length) == 0) return &tag;
+    }
+    return nullptr;
+}
+
+bool PgnReader::open(const std::string& path) {
+    if (!file.open(path)) return false;
+    attach(reinterpret_cast<const char*>(file.data()), file.size());
+    return true;
+}
+
+void PgnReader::attach(const char* text, size_t length) {
+    data = text;
+    size = length;
+    setRange(0, length);
+}
+
+void PgnReader::setRange(size_t begin, size_t end) {
+    position = findGameStart(data, size, begin);
+    rangeEnd = end >= size ? size : findGameStart(data, size, end);
+}
+
+// A game starts at a tag line whose previous line is not a tag line
+size_t PgnReader::findGameStart(const char* text, size_t length, size_t offset) {
+    for (size_t i = offset; i < length; ++i) {
+        if (text[i] != '[' || (i > 0 && text[i - 1] != '\n')) continue;
+        if (i == 0) return 0;
+
+        size_t previous = i - 1;  // the '\n' ending the previous line
+        while (previous > 0 && text[previous - 1] != '\n') --previous;
+        if (text[previous] != '[') return i;
+    }
+    return length;
+}
+
+std::vector<size_t> PgnReader::shardBoundaries(size_t length, int shards) {
+    if (shards < 1) shards = 1;
+    std::vector<size_t> boundaries;
+    for (int i = 0; i <= shards; ++i) {
+        boundaries.push_back((size_t)((double)length * i / shards));
+    }
+    return boundaries;
+}
+
+bool PgnReader::nextGame(PgnGame& game) {
+    while (position < rangeEnd && isBlank(data[position])) ++position;
+    if (position >= rangeEnd) return false;
+
+    game.offset = position;
+    game.tags.clear();
+    game.moves.clear();
+    game.plyCount = 0;
+    game.result = PgnResult::Unknown;
+    game.error = false;
+    game.errorPly = -1;
+
+    readTags(game);
+
+    if (replay) {
+        // Start position: the FEN tag if present, copied out because the text is not NUL-terminated
+        const PgnTag* fenTag = game.findTag("FEN");
+        char fen[Board::FEN_BUFFER_SIZE];
+        FenState state;
+        bool loaded = false;
+        if (fenTag && fenTag->valueLength < sizeof(fen)) {
+            memcpy(fen, fenTag->value, fenTag->valueLength);
+            fen[fenTag->valueLength] = '\0';
+            loaded = game.board.loadFEN(fen, state);
+        }
+        if (!loaded) {
+            game.board.loadFEN(START_FEN, state);
+            if (fenTag) {
+                game.error = true;
+                game.errorPly = 0;
+            }
+        }
+        game.whiteTurn = state.whiteTurn;
+    }
+
+    readMovetext(game);
+    return true;
+}
+
+void PgnReader::readTags(PgnGame& game) {
+    while (position < size) {
+        while (position < size && isBlank(data[position])) ++position;
+        if (position >= size || data[position] != '[') return;
+
+        // [Name "Value"]
+        size_t p = position + 1;
+        while (p < size && isBlank(data[p])) ++p;
+        size_t nameStart = p;
+        while (p < size && !isBlank(data[p]) && data[p] != '"' && data[p] != ']') ++p;
+        size_t nameEnd = p;
+        while (p < size && data[p] != '"' && data[p] != ']' && data[p] != '\n') ++p;
+
+        size_t valueStart = p, valueEnd = p;
+        if (p < size && data[p] == '"') {
+            valueStart = ++p;
+            while (p < size && data[p] != '"' && data[p] != '\n') {
+                if (data[p] == '\\' && p + 1 < size) ++p;
+                ++p;
+            }
+            valueEnd = p;
+        }
+        while (p < size && data[p] != '\n') ++p;  // rest of the line
+
+        if (nameEnd > nameStart) {
+            game.tags.push_back({ data + nameStart, nameEnd - nameStart, data + valueStart, valueEnd - valueStart });
+        }
+        position = p;
+    }
+}
+
+void PgnReader::readMovetext(PgnGame& game) {
+    while (position < size) {
+        char c = data[position];
+        if (isBlank(c)) {
+            ++position;
+            continue;
+        }
+
+        bool lineStart = position == 0 || data[position - 1] == '\n';
+        if (lineStart && c == '[') return;  // tags of the next game, no result token
+        if (lineStart && c == '%') c = ';';  // escape line
+
+        if (c == '{') {
+            while (position < size && data[position] != '}') ++position;
+            ++position;
+            continue;
+        }
+        if (c == ';') {
+            while (position < size && data[position] != '\n') ++position;
+            continue;
+        }
+        if (c == '(') {
+            // Variation, possibly nested, possibly with comments
+            int depth = 0;
+            while (position < size) {
+                char v = data[position++];
+                if (v == '{') {
+                    while (position < size && data[position] != '}') ++position;
+                    ++position;
+                }
+                else if (v == '(') {
+                    ++depth;
+                }
+                else if (v == ')' && --depth == 0) {
+                    break;
+                }
+            }
+            continue;
+        }
+        if (c == ')' || c == '$' || c == '!' || c == '?') {
+            ++position;
+            while (position < size && data[position] >= '0' && data[position] <= '9') ++position;
+            continue;
+        }
+
+        // Token up to the next separator
+        size_t start = position;
+        while (position < size && !isBlank(data[position]) && data[position] != '{' &&
+            data[position] != '(' && data[position] != ')' && data[position] != ';') {
+            ++position;
+        }
+        const char* token = data + start;
+        size_t length = position - start;
+
+        if (length == 1 && token[0] == '*') {
+            game.result = PgnResult::Unknown;
+            return;
+        }
+        if (token[0] >= '0' && token[0] <= '9') {
+            if ((length == 3 && memcmp(token, "1-0", 3) == 0)) {
+                game.result = PgnResult::WhiteWins;
+                return;
+            }
+            if ((length == 3 && memcmp(token, "0-1", 3) == 0)) {
+                game.result = PgnResult::BlackWins;
+                return;
+            }
+            if (length == 7 && memcmp(token, "1/2-1/2", 7) == 0) {
+                game.result = PgnResult::Draw;
+                return;
+            }
+
+            // Move number: "12." or "12..." possibly glued to the move, as in "12.e4"
+            size_t digits = 0;
+            while (digits < length && token[digits] >= '0' && token[digits] <= '9') ++digits;
+            if (digits < length && token[digits] == '.') {
+                while (digits < length && token[digits] == '.') ++digits;
+                position = start + digits;
+                continue;
+            }
+            // Otherwise "0-0" / "0-0-0" castling, handled as SAN below
+        }
+
+        if (replay && !game.error) {
+            SimpleMove move = {};
+            if (playSan(game.board, game.whiteTurn, token, length, move)) {
+                game.moves.push_back(move);
+                game.whiteTurn = !game.whiteTurn;
+            }
+            else {
+                game.error = true;
+                game.errorPly = game.plyCount;
+            }
+        }
+        ++game.plyCount;
+    }
+}
+
+bool PgnReader::playSan(Board& board, bool whiteTurn, const char* san, size_t length, SimpleMove& move) {
+    // Check marks and annotation glyphs
+    while (length > 0 && (san[length - 1] == '+' || san[length - 1] == '#' ||
+        san[length - 1] == '!' || san[length - 1] == '?')) {
+        --length;
+    }
+    if (length < 2) return false;
+
+    // Castling, with letter O or digit zero
+    if (san[0] == 'O' || san[0] == '0') {
+        int row = whiteTurn ? 7 : 0;
+        int toCol;
+        if (length == 3 && san[1] == '-' && san[2] == san[0]) toCol = 6;
+        else if (length == 5 && san[1] == '-' && san[3] == '-' && san[2] == san[0] && san[4] == san[0]) toCol = 2;
+        else return false;
+        if (!board.playMove(row, 4, row, toCol, whiteTurn)) return false;
+        move = { row, 4, row, toCol };
+        return true;
+    }
+
+    char pieceType = 'P';
+    size_t i = 0;
+    if (strchr("NBRQK", san[0])) pieceType = san[i++];
+
+    // Promotion suffix, "=Q" or plain "Q"
+    char promotion = 0;
+    if (length >= 2 && san[length - 2] == '=') {
+        promotion = san[length - 1];
+        length -= 2;
+    }
+    else if (pieceType == 'P' && strchr("NBRQ", san[length - 1])) {
+        promotion = san[length - 1];
+        length -= 1;
+    }
+    // Board::movePiece always promotes to a queen
+    if (promotion && promotion != 'Q') return false;
+
+    if (length < i + 2) return false;
+    char toFile = san[length - 2], toRank = san[length - 1];
+    if (toFile < 'a' || toFile > 'h' || toRank < '1' || toRank > '8') return false;
+    int toRow = '8' - toRank, toCol = toFile - 'a';
+
+    // Disambiguation between the piece letter and the target; also accepts long algebraic "e2-e4"
+    int fromRow = -1, fromCol = -1;
+    for (size_t k = i; k < length - 2; ++k) {
+        char d = san[k];
+        if (d >= 'a' && d <= 'h') fromCol = d - 'a';
+        else if (d >= '1' && d <= '8') fromRow = '8' - d;
+        else if (d != 'x' && d != ':' && d != '-') return false;
+    }
+
+    char symbol = whiteTurn ? pieceType : (char)(pieceType + ('a' - 'A'));
+    for (int row = 0; row < 8; ++row) {
+        if (fromRow >= 0 && row != fromRow) continue;
+        for (int col = 0; col < 8; ++col) {
+            if (fromCol >= 0 && col != fromCol) continue;
+            Piece* piece = board.getPiece(row, col);
+            if (!piece || piece->getSymbol() != symbol) continue;
+            if (!piece->isValidMove(row, col, toRow, toCol, &board)) continue;
+            // movePiece rejects a pinned candidate without touching the board,
+            // so the first one it accepts is the move SAN meant
+            if (board.playMove(row, col, toRow, toCol, whiteTurn)) {
+                move = { row, col, toRow, toCol };
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "Board.h"
+#include "Moves.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class PgnResult {
+    WhiteWins,
+    BlackWins,
+    Draw,
+    Unknown
+};
+
+// Tag pair as views into the PGN text; valid while the reader's data is mapped
+struct PgnTag {
+    const char* name;
+    size_t nameLength;
+    const char* value;   // without the quotes, escapes left as written
+    size_t valueLength;
+};
+
+// One game as read by PgnReader. The vectors and the board are reused from
+// game to game, so reading a whole database does not grow memory.
+struct PgnGame {
+    size_t offset = 0;                // byte offset of the game's first tag
+    std::vector<PgnTag> tags;
+    std::vector<SimpleMove> moves;    // resolved moves (only when replaying)
+    int plyCount = 0;                 // SAN moves in the main line
+    PgnResult result = PgnResult::Unknown;
+    Board board;                      // final position after replay
+    bool whiteTurn = true;            // side to move in 'board'
+    bool error = false;               // a move could not be resolved; replay stopped there
+    int errorPly = -1;
+
+    const PgnTag* findTag(const char* name) const;
+};
+
+// Streaming PGN reader over a memory-mapped file. Tags and movetext are
+// tokenized in place; with replay on, every SAN move is resolved against the
+// board and played. Comments, NAGs and variations are skipped.
+//
+// For multithreaded reading, give each reader a byte range of the same data
+// (see shardBoundaries): a reader handles exactly the games whose first tag
+// lies in its range, so neighbouring shards neither miss nor repeat a game.
+class PgnReader {
+private:
+    MappedFile file;
+    const char* data = nullptr;
+    size_t size = 0;
+    size_t position = 0;
+    size_t rangeEnd = 0;
+    bool replay = true;
+
+    void readTags(PgnGame& game);
+    void readMovetext(PgnGame& game);
+
+public:
+    bool open(const std::string& path);                 // maps the file and reads all of it
+    void attach(const char* text, size_t length);       // reads text owned by the caller
+    void setRange(size_t begin, size_t end);            // games starting in [begin, end)
+    void setReplay(bool enabled) { replay = enabled; }  // off = tokenize only
+
+    const char* getData() const { return data; }
+    size_t getSize() const { return size; }
+
+    // Reads the next game; false once the range is exhausted
+    bool nextGame(PgnGame& game);
+
+    // Start of the first game at or after offset, or 'length' if there is none
+    static size_t findGameStart(const char* text, size_t length, size_t offset);
+    // 'shards' + 1 offsets splitting the text into ranges of roughly equal size
+    static std::vector<size_t> shardBoundaries(size_t length, int shards);
+
+    // Resolves one SAN move (e.g. "Nbd7", "exd8=Q+", "O-O") and plays it on the board
+    static bool playSan(Board& board, bool whiteTurn, const char* san, size_t length, SimpleMove& move);
+};
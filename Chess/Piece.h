@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <new>
 
 class Board; 
 
@@ -16,4 +17,6 @@ public:
     virtual char getSymbol() const = 0;
     virtual bool isValidMove(int fromRow, int fromCol, int toRow, int toCol, Board* board) = 0;
     virtual Piece* clone() const = 0;
+    // Copy constructed in caller-provided storage (PieceArena)
+    virtual Piece* cloneInto(void* memory) const = 0;
 };
@@ -0,0 +1,51 @@
+#include "PieceArena.h"
+#include "Pawn.h"
+#include "Rook.h"
+#include "Knight.h"
+#include "Bishop.h"
+#include "Queen.h"
+#include "King.h"
+#include "Bitboard.h"
+
+static_assert(sizeof(Pawn) <= PieceArena::SLOT_SIZE && sizeof(Rook) <= PieceArena::SLOT_SIZE &&
+    sizeof(Knight) <= PieceArena::SLOT_SIZE && sizeof(Bishop) <= PieceArena::SLOT_SIZE &&
+    sizeof(Queen) <= PieceArena::SLOT_SIZE && sizeof(King) <= PieceArena::SLOT_SIZE,
+    "a piece does not fit in an arena slot");
+static_assert(PieceArena::CAPACITY == 64, "the used mask has one bit per slot");
+
+void* PieceArena::allocate() {
+    if (used == ~0ULL) return nullptr;
+    int slot = lsb(~used);
+    used |= 1ULL << slot;
+    return slots[slot];
+}
+
+Piece* PieceArena::copy(const Piece* piece) {
+    void* memory = allocate();
+    return memory ? piece->cloneInto(memory) : piece->clone();
+}
+
+void PieceArena::release(Piece* piece) {
+    if (!piece) return;
+    if (!owns(piece)) {
+        delete piece;
+        return;
+    }
+    int slot = (int)((reinterpret_cast<unsigned char*>(piece) - slots[0]) / SLOT_SIZE);
+    piece->~Piece();
+    used &= ~(1ULL << slot);
+}
+
+void PieceArena::clear() {
+    uint64_t remaining = used;
+    while (remaining) {
+        int slot = lsb(remaining);
+        remaining &= remaining - 1;
+        reinterpret_cast<Piece*>(slots[slot])->~Piece();
+    }
+    used = 0;
+}
+
+int PieceArena::getCount() const {
+    return popCount(used);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "Piece.h"
+#include <cstddef>
+#include <cstdint>
+
+// Storage for the pieces of one Board: fixed slots inside the board, so
+// copying a board or promoting a pawn constructs pieces in place instead of
+// going to the heap. A board never holds more than 33 pieces at once (32
+// plus the queen of a promotion before the pawn is released), so the slots
+// do not run out in play; if they ever did, pieces fall back to the heap.
+class PieceArena {
+public:
+    static const int CAPACITY = 64;
+    static const size_t SLOT_SIZE = 16;
+
+    PieceArena() = default;
+    ~PieceArena() { clear(); }
+    // A board copies its pieces one by one into its own arena
+    PieceArena(const PieceArena&) = delete;
+    PieceArena& operator=(const PieceArena&) = delete;
+
+    template <class T>
+    Piece* create(bool white) {
+        void* memory = allocate();
+        return memory ? new (memory) T(white) : new T(white);
+    }
+    Piece* copy(const Piece* piece);
+    // Destroys a piece created by this arena, or deletes a heap fallback
+    void release(Piece* piece);
+    // Destroys every piece in the slots
+    void clear();
+
+    bool owns(const Piece* piece) const {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(piece);
+        return p >= slots[0] && p < slots[0] + sizeof(slots);
+    }
+    int getCount() const;
+
+private:
+    alignas(std::max_align_t) unsigned char slots[CAPACITY][SLOT_SIZE];
+    uint64_t used = 0;  // bit i set = slot i holds a piece
+
+    void* allocate();
+};
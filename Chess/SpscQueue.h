@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Bounded single-producer single-consumer queue. push and pop never lock or
+// wait: each side owns one index and publishes it with release/acquire, so
+// one thread can feed another (a search thread feeding the GUI) without
+// either ever blocking. Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+private:
+    T items[Capacity];
+    alignas(64) std::atomic<size_t> head{ 0 };  // next item to pop, written by the consumer
+    alignas(64) std::atomic<size_t> tail{ 0 };  // next free slot, written by the producer
+
+public:
+    // Producer only; false when the queue is full
+    bool push(T&& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Capacity) return false;
+        items[t & (Capacity - 1)] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only; false when the queue is empty
+    bool pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        item = std::move(items[h & (Capacity - 1)]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
@@ -0,0 +1,337 @@
+#include "Tablebase.h"
+#include "Board.h"
+#include "MappedFile.h"
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// Table layout: one byte per position, indexed by
+//   ((sideToMove * 64 + strongKing) * 64 + weakKing) * 64 + piece
+// where the strong side owns the extra piece and is oriented as White
+// (its pawn moves towards row 0). sideToMove 0 = strong side.
+// Byte values: 0 = draw or illegal, 1..127 = win in n plies,
+// 128 + n = loss in n plies.
+static const int TABLE_POSITIONS = 2 * 64 * 64 * 64;
+static const char MAGIC[8] = { 'S', 'W', 'A', 'G', 'T', 'B', '0', '1' };
+static const size_t HEADER_SIZE = 16;  // magic, piece letter, padding
+static const uint8_t LOSS_FLAG = 128;
+
+namespace {
+    // Tables in the order of their piece letter
+    const char TABLE_PIECES[3] = { 'Q', 'R', 'P' };
+
+    struct TableSet {
+        std::string directory;
+        MappedFile files[3];
+        const uint8_t* tables[3] = { nullptr, nullptr, nullptr };
+    };
+
+    TableSet& tableSet() {
+        static TableSet instance;
+        return instance;
+    }
+
+    int tableSlot(char piece) {
+        for (int i = 0; i < 3; ++i)
+            if (TABLE_PIECES[i] == piece) return i;
+        return -1;
+    }
+
+    std::string tablePath(const std::string& directory, char piece) {
+        std::string path = directory;
+        if (!path.empty() && path.back() != '/' && path.back() != '\\') path += '/';
+        return path + "K" + piece + "vK.swtb";
+    }
+
+    inline int tableIndex(int side, int strongKing, int weakKing, int piece) {
+        return ((side * 64 + strongKing) * 64 + weakKing) * 64 + piece;
+    }
+
+    inline bool adjacent(int a, int b) {
+        int dr = a / 8 - b / 8, dc = a % 8 - b % 8;
+        return dr >= -1 && dr <= 1 && dc >= -1 && dc <= 1;
+    }
+
+    // Whether a queen/rook on 'from' attacks 'target', blocked only by 'blocker'
+    bool sliderAttacks(char piece, int from, int target, int blocker) {
+        int fr = from / 8, fc = from % 8, tr = target / 8, tc = target % 8;
+        int dr = tr - fr, dc = tc - fc;
+        bool straight = (dr == 0 || dc == 0);
+        bool diagonal = (dr == dc || dr == -dc);
+        if (from == target || !(straight || (piece == 'Q' && diagonal))) return false;
+        int sr = (dr > 0) - (dr < 0), sc = (dc > 0) - (dc < 0);
+        for (int r = fr + sr, c = fc + sc; r != tr || c != tc; r += sr, c += sc)
+            if (r * 8 + c == blocker) return false;
+        return true;
+    }
+
+    // Whether the strong side attacks 'target' (the weak king is not a blocker here)
+    bool strongAttacks(char piece, int strongKing, int pieceSquare, int target) {
+        if (adjacent(strongKing, target)) return true;
+        if (piece == 'P') {
+            int r = pieceSquare / 8, c = pieceSquare % 8;
+            return target / 8 == r - 1 && (target % 8 == c - 1 || target % 8 == c + 1);
+        }
+        return sliderAttacks(piece, pieceSquare, target, strongKing);
+    }
+
+    bool legalPlacement(char piece, int side, int sk, int wk, int x) {
+        if (sk == wk || x == sk || x == wk || adjacent(sk, wk)) return false;
+        if (piece == 'P' && (x / 8 == 0 || x / 8 == 7)) return false;
+        // With the strong side to move, the weak king must not already be in check
+        if (side == 0 && strongAttacks(piece, sk, x, wk)) return false;
+        return true;
+    }
+
+    inline bool isWin(uint8_t v) { return v != 0 && v < LOSS_FLAG; }
+    inline bool isLoss(uint8_t v) { return v >= LOSS_FLAG; }
+
+    // Retrograde solver for one table. 'queenTable' resolves pawn promotions.
+    std::vector<uint8_t> solve(char piece, const std::vector<uint8_t>* queenTable) {
+        std::vector<uint8_t> value(TABLE_POSITIONS, 0);
+        std::vector<uint8_t> known(TABLE_POSITIONS, 0);
+        static const int kingSteps[8][2] = { {-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1} };
+
+        // Weak side to move: checkmates are losses in 0, stalemates and captures of the piece are draws
+        for (int sk = 0; sk < 64; ++sk)
+            for (int wk = 0; wk < 64; ++wk)
+                for (int x = 0; x < 64; ++x) {
+                    if (!legalPlacement(piece, 1, sk, wk, x)) continue;
+                    bool hasMove = false;
+                    for (const auto& step : kingSteps) {
+                        int r = wk / 8 + step[0], c = wk % 8 + step[1];
+                        if (r < 0 || r > 7 || c < 0 || c > 7) continue;
+                        int t = r * 8 + c;
+                        if (adjacent(t, sk)) continue;
+                        if (t != x && strongAttacks(piece, sk, x, t)) continue;
+                        hasMove = true;
+                        break;
+                    }
+                    if (!hasMove) {
+                        int index = tableIndex(1, sk, wk, x);
+                        known[index] = 1;
+                        value[index] = strongAttacks(piece, sk, x, wk) ? LOSS_FLAG : 0;
+                    }
+                }
+
+        for (int ply = 1; ply < 127; ++ply) {
+            bool changed = false;
+            if (ply % 2 == 1) {
+                // Strong side to move wins in 'ply' if some move reaches a loss in ply - 1
+                uint8_t target = (uint8_t)(LOSS_FLAG + ply - 1);
+                for (int sk = 0; sk < 64; ++sk)
+                    for (int wk = 0; wk < 64; ++wk)
+                        for (int x = 0; x < 64; ++x) {
+                            int index = tableIndex(0, sk, wk, x);
+                            if (known[index] || !legalPlacement(piece, 0, sk, wk, x)) continue;
+                            bool wins = false;
+
+                            for (const auto& step : kingSteps) {
+                                int r = sk / 8 + step[0], c = sk % 8 + step[1];
+                                if (r < 0 || r > 7 || c < 0 || c > 7) continue;
+                                int t = r * 8 + c;
+                                if (t == x || adjacent(t, wk)) continue;
+                                if (value[tableIndex(1, t, wk, x)] == target && known[tableIndex(1, t, wk, x)]) {
+                                    wins = true;
+                                    break;
+                                }
+                            }
+
+                            if (!wins && piece == 'P') {
+                                int r = x / 8, c = x % 8;
+                                int one = (r - 1) * 8 + c;
+                                if (one != sk && one != wk) {
+                                    if (r - 1 == 0) {
+                                        // Promotion: continue in the queen table
+                                        if ((*queenTable)[tableIndex(1, sk, wk, one)] == target) wins = true;
+                                    }
+                                    else {
+                                        int child = tableIndex(1, sk, wk, one);
+                                        if (known[child] && value[child] == target) wins = true;
+                                        int two = (r - 2) * 8 + c;
+                                        if (!wins && r == 6 && two != sk && two != wk) {
+                                            child = tableIndex(1, sk, wk, two);
+                                            if (known[child] && value[child] == target) wins = true;
+                                        }
+                                    }
+                                }
+                            }
+                            else if (!wins) {
+                                for (const auto& step : kingSteps) {
+                                    if (piece == 'R' && step[0] != 0 && step[1] != 0) continue;
+                                    int r = x / 8 + step[0], c = x % 8 + step[1];
+                                    while (r >= 0 && r < 8 && c >= 0 && c < 8) {
+                                        int t = r * 8 + c;
+                                        if (t == sk || t == wk) break;
+                                        int child = tableIndex(1, sk, wk, t);
+                                        if (known[child] && value[child] == target) {
+                                            wins = true;
+                                            break;
+                                        }
+                                        r += step[0];
+                                        c += step[1];
+                                    }
+                                    if (wins) break;
+                                }
+                            }
+
+                            if (wins) {
+                                known[index] = 1;
+                                value[index] = (uint8_t)ply;
+                                changed = true;
+                            }
+                        }
+            }
+            else {
+                // Weak side to move loses in 'ply' once every move reaches a known win
+                for (int sk = 0; sk < 64; ++sk)
+                    for (int wk = 0; wk < 64; ++wk)
+                        for (int x = 0; x < 64; ++x) {
+                            int index = tableIndex(1, sk, wk, x);
+                            if (known[index] || !legalPlacement(piece, 1, sk, wk, x)) continue;
+                            bool allWin = true;
+                            int longest = 0;
+                            for (const auto& step : kingSteps) {
+                                int r = wk / 8 + step[0], c = wk % 8 + step[1];
+                                if (r < 0 || r > 7 || c < 0 || c > 7) continue;
+                                int t = r * 8 + c;
+                                if (adjacent(t, sk)) continue;
+                                if (t == x) {
+                                    allWin = false;  // the piece is hanging: capturing it draws
+                                    break;
+                                }
+                                if (strongAttacks(piece, sk, x, t)) continue;
+                                int child = tableIndex(0, sk, t, x);
+                                if (!known[child] || !isWin(value[child])) {
+                                    allWin = false;
+                                    break;
+                                }
+                                if (value[child] > longest) longest = value[child];
+                            }
+                            if (allWin && longest == ply - 1) {
+                                known[index] = 1;
+                                value[index] = (uint8_t)(LOSS_FLAG + ply);
+                                changed = true;
+                            }
+                        }
+            }
+
+            // Each pass only extends the previous one, so a quiet pass means the table is complete
+            if (!changed) break;
+        }
+        return value;
+    }
+
+    bool writeTable(const std::string& directory, char piece, const std::vector<uint8_t>& table) {
+        std::ofstream out(tablePath(directory, piece), std::ios::binary);
+        if (!out) return false;
+        char header[HEADER_SIZE] = {};
+        memcpy(header, MAGIC, sizeof(MAGIC));
+        header[8] = piece;
+        out.write(header, HEADER_SIZE);
+        out.write(reinterpret_cast<const char*>(table.data()), (std::streamsize)table.size());
+        return (bool)out;
+    }
+}
+
+int Tablebase::init(const std::string& directory) {
+    TableSet& set = tableSet();
+    set.directory = directory;
+    int mapped = 0;
+    for (int i = 0; i < 3; ++i) {
+        set.tables[i] = nullptr;
+        set.files[i].close();
+        MappedFile& file = set.files[i];
+        if (directory.empty() || !file.open(tablePath(directory, TABLE_PIECES[i]))) continue;
+        if (file.size() != HEADER_SIZE + TABLE_POSITIONS ||
+            memcmp(file.data(), MAGIC, sizeof(MAGIC)) != 0 || file.data()[8] != TABLE_PIECES[i]) {
+            file.close();
+            continue;
+        }
+        set.tables[i] = file.data() + HEADER_SIZE;
+        ++mapped;
+    }
+    return mapped;
+}
+
+bool Tablebase::isAvailable() {
+    const TableSet& set = tableSet();
+    return set.tables[0] || set.tables[1] || set.tables[2];
+}
+
+std::string Tablebase::getDirectory() {
+    return tableSet().directory;
+}
+
+bool Tablebase::probe(const Board& board, bool whiteTurn, TablebaseResult& result) {
+    int kings[2] = { -1, -1 };  // [0] = white, [1] = black
+    int pieceSquare = -1;
+    char pieceType = 0;
+    bool pieceWhite = true;
+    int count = 0;
+
+    for (int row = 0; row < 8; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            Piece* p = board.getPiece(row, col);
+            if (!p) continue;
+            if (++count > MAX_PIECES) return false;
+            char symbol = (char)toupper(p->getSymbol());
+            if (symbol == 'K') {
+                kings[p->isWhitePiece() ? 0 : 1] = row * 8 + col;
+            }
+            else {
+                pieceSquare = row * 8 + col;
+                pieceType = symbol;
+                pieceWhite = p->isWhitePiece();
+            }
+        }
+    }
+    if (kings[0] < 0 || kings[1] < 0) return false;
+
+    // Bare kings and a lone minor piece cannot mate
+    if (count == 2 || pieceType == 'B' || pieceType == 'N') {
+        result.wdl = 0;
+        result.distance = 0;
+        return true;
+    }
+
+    int slot = tableSlot(pieceType);
+    const uint8_t* table = slot >= 0 ? tableSet().tables[slot] : nullptr;
+    if (!table) return false;
+
+    // Orient the strong side as White
+    int strongKing = pieceWhite ? kings[0] : kings[1];
+    int weakKing = pieceWhite ? kings[1] : kings[0];
+    if (!pieceWhite) {
+        strongKing ^= 56;  // flips the row
+        weakKing ^= 56;
+        pieceSquare ^= 56;
+    }
+    int side = (whiteTurn == pieceWhite) ? 0 : 1;
+
+    uint8_t v = table[tableIndex(side, strongKing, weakKing, pieceSquare)];
+    if (v == 0) {
+        result.wdl = 0;
+        result.distance = 0;
+    }
+    else if (isLoss(v)) {
+        result.wdl = -1;
+        result.distance = v - LOSS_FLAG;
+    }
+    else {
+        result.wdl = 1;
+        result.distance = v;
+    }
+    return true;
+}
+
+bool Tablebase::generate(const std::string& directory) {
+    std::vector<uint8_t> queen = solve('Q', nullptr);
+    std::vector<uint8_t> rook = solve('R', nullptr);
+    std::vector<uint8_t> pawn = solve('P', &queen);
+    return writeTable(directory, 'Q', queen) &&
+        writeTable(directory, 'R', rook) &&
+        writeTable(directory, 'P', pawn);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+
+class Board;
+
+// Result of a tablebase probe, from the side to move's point of view
+struct TablebaseResult {
+    int wdl = 0;       // 1 = win, 0 = draw, -1 = loss
+    int distance = 0;  // plies to mate with best play (0 for draws)
+};
+
+// Endgame tablebases for king + queen, rook or pawn against a lone king.
+// Tables are built once by retrograde analysis (generate, or the TablebaseGen
+// tool) into a local directory and memory-mapped from there by init. Each
+// table stores, for every placement and side to move, win/draw/loss and the
+// distance to mate in plies. Pawn promotions are to a queen only, matching
+// Board::movePiece. Lone minor pieces and bare kings are known draws and
+// need no file. This is the engine's own format, not Syzygy's.
+class Tablebase {
+public:
+    static const int MAX_PIECES = 3;
+    static constexpr const char* DEFAULT_DIRECTORY = "tablebases";
+
+    // Maps every table found in the directory; returns the number of tables mapped.
+    // Tables mapped before are released; an empty directory leaves none mapped.
+    static int init(const std::string& directory);
+    static bool isAvailable();
+    static std::string getDirectory();
+
+    // False when the position is not covered by a mapped table
+    static bool probe(const Board& board, bool whiteTurn, TablebaseResult& result);
+
+    // Builds the tables and writes them into the directory
+    static bool generate(const std::string& directory);
+};
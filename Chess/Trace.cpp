@@ -0,0 +1,140 @@
+#include "Trace.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Event {
+    const char* name;
+    int64_t startNs;     // since the trace epoch
+    int64_t durationNs;  // -1 for an instant event
+    int64_t value;
+    char detail[Trace::DETAIL_SIZE];
+};
+
+struct ThreadBuffer {
+    int tid;
+    const char* threadName = nullptr;
+    std::atomic<uint64_t> written{ 0 };  // events ever recorded; the slot is written % EVENTS_PER_THREAD
+    Event events[Trace::EVENTS_PER_THREAD];
+};
+
+// Buffers live until the process ends, so the events of finished threads are still written
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+const Trace::TimePoint epoch = std::chrono::steady_clock::now();
+
+ThreadBuffer& threadBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.emplace_back(new ThreadBuffer());
+        buffer = registry.back().get();
+        buffer->tid = (int)registry.size();
+    }
+    return *buffer;
+}
+
+int64_t sinceEpoch(Trace::TimePoint t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t - epoch).count();
+}
+
+void record(const char* name, int64_t startNs, int64_t durationNs, int64_t value, const char* detail) {
+    ThreadBuffer& buffer = threadBuffer();
+    uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    Event& e = buffer.events[index % Trace::EVENTS_PER_THREAD];
+    e.name = name;
+    e.startNs = startNs;
+    e.durationNs = durationNs;
+    e.value = value;
+    if (detail) {
+        strncpy(e.detail, detail, Trace::DETAIL_SIZE - 1);
+        e.detail[Trace::DETAIL_SIZE - 1] = '\0';
+    }
+    else {
+        e.detail[0] = '\0';
+    }
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+// Names are literals from the source; only quotes and backslashes need escaping
+void writeString(FILE* out, const char* s) {
+    fputc('"', out);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        if ((unsigned char)*s >= 0x20) fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+}
+
+TraceScope::TraceScope(const char* name, int64_t value, const char* detail)
+    : name(name), value(value), start(std::chrono::steady_clock::now()) {
+    if (detail) {
+        strncpy(this->detail, detail, Trace::DETAIL_SIZE - 1);
+        this->detail[Trace::DETAIL_SIZE - 1] = '\0';
+    }
+    else {
+        this->detail[0] = '\0';
+    }
+}
+
+void Trace::complete(const char* name, TimePoint start, TimePoint end, int64_t value, const char* detail) {
+    int64_t startNs = sinceEpoch(start);
+    record(name, startNs, sinceEpoch(end) - startNs, value, detail && detail[0] ? detail : nullptr);
+}
+
+void Trace::instant(const char* name, int64_t value) {
+    record(name, sinceEpoch(std::chrono::steady_clock::now()), -1, value, nullptr);
+}
+
+void Trace::setThreadName(const char* name) {
+    threadBuffer().threadName = name;
+}
+
+bool Trace::write(const std::string& path) {
+    FILE* out = fopen(path.c_str(), "w");
+    if (!out) return false;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const std::unique_ptr<ThreadBuffer>& buffer : registry) {
+        if (buffer->threadName) {
+            fprintf(out, "%s{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":",
+                first ? "" : ",\n", buffer->tid);
+            writeString(out, buffer->threadName);
+            fprintf(out, "}}");
+            first = false;
+        }
+
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        uint64_t begin = written > (uint64_t)EVENTS_PER_THREAD ? written - EVENTS_PER_THREAD : 0;
+        for (uint64_t i = begin; i < written; ++i) {
+            const Event& e = buffer->events[i % EVENTS_PER_THREAD];
+            fprintf(out, "%s{\"name\":", first ? "" : ",\n");
+            writeString(out, e.name);
+            // Timestamps and durations are in microseconds
+            if (e.durationNs < 0) {
+                fprintf(out, ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f", e.startNs / 1000.0);
+            }
+            else {
+                fprintf(out, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f", e.startNs / 1000.0, e.durationNs / 1000.0);
+            }
+            fprintf(out, ",\"pid\":1,\"tid\":%d,\"args\":{\"value\":%lld", buffer->tid, (long long)e.value);
+            if (e.detail[0]) {
+                fprintf(out, ",\"detail\":");
+                writeString(out, e.detail);
+            }
+            fprintf(out, "}}");
+            first = false;
+        }
+    }
+    fprintf(out, "\n]}\n");
+    return fclose(out) == 0;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Scoped trace points written as Chrome trace-event JSON, for chrome://tracing
+// or Perfetto. Tracing is compiled in only when CHESS_TRACE is defined (the
+// CHESS_ENABLE_TRACE CMake option); otherwise every TRACE_ macro expands to
+// nothing and its arguments are never evaluated.
+//
+// Each thread records into its own fixed ring buffer, so a trace point is a
+// clock read and a store with no locking; when a buffer wraps, the oldest
+// events of that thread are dropped. Events are complete ("X") events: a
+// scope records one event when it ends, with its start and duration.
+class Trace {
+public:
+    static const int EVENTS_PER_THREAD = 1 << 15;
+    static const int DETAIL_SIZE = 8;
+
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    // Records a finished span; name must be a string literal or otherwise outlive the trace.
+    // detail is copied (up to DETAIL_SIZE - 1 characters) and shown with value as arguments.
+    static void complete(const char* name, TimePoint start, TimePoint end,
+        int64_t value = 0, const char* detail = nullptr);
+    // Records a zero-length event
+    static void instant(const char* name, int64_t value = 0);
+    // Names the calling thread in the trace
+    static void setThreadName(const char* name);
+
+    // Writes the events of every thread, including threads that have exited.
+    // Threads that are still recording may lose events that are written meanwhile.
+    static bool write(const std::string& path);
+};
+
+// Records the enclosing scope as one complete event
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, int64_t value = 0, const char* detail = nullptr);
+    ~TraceScope() { Trace::complete(name, start, std::chrono::steady_clock::now(), value, detail); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    int64_t value;
+    char detail[Trace::DETAIL_SIZE];
+    Trace::TimePoint start;
+};
+
+#ifdef CHESS_TRACE
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_SCOPE_VALUE(name, value) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name, (int64_t)(value))
+#define TRACE_SCOPE_DETAIL(name, value, detail) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name, (int64_t)(value), detail)
+#define TRACE_COMPLETE(name, start, end) Trace::complete(name, start, end)
+#define TRACE_INSTANT(name, value) Trace::instant(name, (int64_t)(value))
+#define TRACE_THREAD_NAME(name) Trace::setThreadName(name)
+#define TRACE_WRITE(path) Trace::write(path)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_VALUE(name, value)
+#define TRACE_SCOPE_DETAIL(name, value, detail)
+#define TRACE_COMPLETE(name, start, end)
+#define TRACE_INSTANT(name, value)
+#define TRACE_THREAD_NAME(name)
+#define TRACE_WRITE(path)
+#endif
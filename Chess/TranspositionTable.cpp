@@ -0,0 +1,68 @@
+#include "TranspositionTable.h"
+#include "Trace.h"
+
+// Data layout: score (bits 0-31), depth (32-39), bound (40-41),
+// move from square (42-47), to square (48-53), move present (54)
+static uint64_t pack(int score, int depth, TTBound bound, const SimpleMove* move) {
+    uint64_t data = (uint32_t)(int32_t)score;
+    data |= (uint64_t)(uint8_t)depth << 32;
+    data |= (uint64_t)bound << 40;
+    if (move && move->fromRow >= 0) {
+        data |= (uint64_t)(move->fromRow * 8 + move->fromCol) << 42;
+        data |= (uint64_t)(move->toRow * 8 + move->toCol) << 48;
+        data |= 1ULL << 54;
+    }
+    return data;
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes) {
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+    TRACE_SCOPE_VALUE("tt resize", megabytes);
+    // Power of two slot count so the index is a mask of the key
+    size_t wanted = (megabytes << 20) / sizeof(Slot);
+    size_t count = 1;
+    while (count * 2 <= wanted) count *= 2;
+
+    slots.reset(new Slot[count]);
+    slotCount = count;
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < slotCount; ++i) {
+        slots[i].check.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    const Slot& slot = slots[key & (slotCount - 1)];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if (data == 0 || (check ^ data) != key) return false;
+
+    entry.score = (int)(int32_t)(uint32_t)data;
+    entry.depth = (int)((data >> 32) & 0xFF);
+    entry.bound = (TTBound)((data >> 40) & 3);
+    if (data & (1ULL << 54)) {
+        int from = (int)((data >> 42) & 63), to = (int)((data >> 48) & 63);
+        entry.move = { from / 8, from % 8, to / 8, to % 8 };
+    }
+    else {
+        entry.move = { -1, -1, -1, -1 };
+    }
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, int score, int depth, TTBound bound, const SimpleMove* move) {
+    Slot& slot = slots[key & (slotCount - 1)];
+    uint64_t oldData = slot.data.load(std::memory_order_relaxed);
+    uint64_t oldCheck = slot.check.load(std::memory_order_relaxed);
+    if ((oldCheck ^ oldData) == key && (int)((oldData >> 32) & 0xFF) > depth) return;
+
+    uint64_t data = pack(score, depth, bound, move);
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+}
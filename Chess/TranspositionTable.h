@@ -0,0 +1,48 @@
+#pragma once
+#include "Moves.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum class TTBound : uint8_t {
+    None,
+    Exact,
+    Lower,  // the score is at least this (fail high)
+    Upper   // the score is at most this (fail low)
+};
+
+struct TTEntry {
+    int score = 0;   // from the side to move's point of view
+    int depth = 0;
+    TTBound bound = TTBound::None;
+    SimpleMove move = { -1, -1, -1, -1 };  // fromRow -1 when no move is stored
+};
+
+// Search results keyed by the position hash, shared by every thread that
+// searches the same game. Slots use the same (key ^ data, data) scheme as
+// EvalCache, so probes and stores never lock and a torn slot reads as a miss.
+class TranspositionTable {
+private:
+    struct Slot {
+        std::atomic<uint64_t> check{ 0 };  // key ^ data
+        std::atomic<uint64_t> data{ 0 };
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t slotCount = 0;
+
+public:
+    static const size_t DEFAULT_MEGABYTES = 16;
+
+    explicit TranspositionTable(size_t megabytes = DEFAULT_MEGABYTES);
+
+    void resize(size_t megabytes);
+    void clear();
+
+    bool probe(uint64_t key, TTEntry& entry) const;
+    // Keeps a deeper result for the same position
+    void store(uint64_t key, int score, int depth, TTBound bound, const SimpleMove* move);
+
+    size_t getSizeBytes() const { return slotCount * sizeof(Slot); }
+};
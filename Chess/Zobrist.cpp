@@ -0,0 +1,75 @@
+#include "Zobrist.h"
+
+namespace {
+    struct ZobristKeys {
+        uint64_t pieces[12][64];
+        uint64_t side;
+        uint64_t castling[16];
+        uint64_t enPassant[8];
+
+        ZobristKeys() {
+            uint64_t seed = 0x5EEDC0FFEE123457ULL;
+            auto next = [&seed]() {
+                // splitmix64
+                uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                return z ^ (z >> 31);
+            };
+            for (auto& piece : pieces)
+                for (uint64_t& key : piece)
+                    key = next();
+            side = next();
+            // Castling keys are the xor of the individual rights so that
+            // losing one right changes the hash the same way in every position
+            uint64_t rightKeys[4] = { next(), next(), next(), next() };
+            for (int rights = 0; rights < 16; ++rights) {
+                castling[rights] = 0;
+                for (int bit = 0; bit < 4; ++bit)
+                    if (rights & (1 << bit)) castling[rights] ^= rightKeys[bit];
+            }
+            for (uint64_t& key : enPassant)
+                key = next();
+        }
+    };
+
+    const ZobristKeys& keys() {
+        static const ZobristKeys instance;
+        return instance;
+    }
+}
+
+int Zobrist::pieceIndex(char symbol) {
+    switch (symbol) {
+    case 'P': return 0;
+    case 'N': return 1;
+    case 'B': return 2;
+    case 'R': return 3;
+    case 'Q': return 4;
+    case 'K': return 5;
+    case 'p': return 6;
+    case 'n': return 7;
+    case 'b': return 8;
+    case 'r': return 9;
+    case 'q': return 10;
+    case 'k': return 11;
+    }
+    return -1;
+}
+
+uint64_t Zobrist::piece(char symbol, int row, int col) {
+    int index = pieceIndex(symbol);
+    return index < 0 ? 0 : keys().pieces[index][row * 8 + col];
+}
+
+uint64_t Zobrist::sideToMove() {
+    return keys().side;
+}
+
+uint64_t Zobrist::castling(int rights) {
+    return keys().castling[rights & 15];
+}
+
+uint64_t Zobrist::enPassant(int col) {
+    return keys().enPassant[col & 7];
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+// Random keys for hashing positions. Keys are generated once from a fixed
+// seed, so hashes are stable between runs.
+class Zobrist {
+public:
+    static uint64_t piece(char symbol, int row, int col);
+    static uint64_t sideToMove();
+    static uint64_t castling(int rights);   // rights: K = 1, Q = 2, k = 4, q = 8
+    static uint64_t enPassant(int col);
+
+    // 0-11 index for a piece symbol (PNBRQK then pnbrqk), -1 if unknown
+    static int pieceIndex(char symbol);
+};
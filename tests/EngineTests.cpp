@@ -0,0 +1,274 @@
+// Regression tests of the engine library, run by ctest.
+//
+// Each group is a function that reports failed checks on stderr. With no
+// argument every group runs; with a group name only that one, which is how
+// CMake registers them as separate tests.
+//
+// Usage: EngineTests [fen | legality | see | record | repetition | search]
+
+#include "Game.h"
+#include "GameRecord.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << endl; \
+            ++failures; \
+        } \
+    } while (0)
+
+static const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Coordinate notation such as "e2e4"; row 0 is rank 8
+static SimpleMove parseMove(const char* text) {
+    return { '8' - text[1], text[0] - 'a', '8' - text[3], text[2] - 'a' };
+}
+
+static bool playMoves(Game& game, const char* moves) {
+    for (const char* p = moves; *p; p += (p[4] ? 5 : 4)) {
+        if (!game.applyMove(parseMove(p))) return false;
+    }
+    return true;
+}
+
+static void testFen() {
+    const char* fens[] = {
+        START_FEN,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 b - - 12 40",
+        "4k3/8/8/8/8/8/8/4K2R w K - 3 60"
+    };
+    for (const char* fen : fens) {
+        Board board;
+        FenState state;
+        CHECK(board.loadFEN(fen, state));
+        char written[Board::FEN_BUFFER_SIZE];
+        CHECK(board.writeFEN(written, sizeof(written), state.whiteTurn, state.halfmoveClock, state.fullmoveNumber) > 0);
+        if (strcmp(written, fen) != 0) {
+            cerr << "  read " << fen << "\n  wrote " << written << endl;
+            ++failures;
+        }
+    }
+
+    // Malformed or unplayable placements leave the board unchanged
+    const char* invalid[] = {
+        "8/8/8/8/8/8/8/8 w - - 0 1",
+        "4k3/8/8/8/8/8/8/R7 w - - 0 1",
+        "4k3/8/8/8/8/8/8/R3KK2 w - - 0 1",
+        "4k2P/8/8/8/8/8/8/4K3 w - - 0 1",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBN w KQkq - 0 1",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1"
+    };
+    for (const char* fen : invalid) {
+        Board board;
+        FenState state;
+        CHECK(!board.loadFEN(fen, state));
+        CHECK(board.getHashKey(true) == Board().getHashKey(true));
+    }
+}
+
+static void testLegality() {
+    // On the heap like the UCI engine's games, where stray reads off the board meet zeroed memory
+    unique_ptr<Game> owner(new Game());
+    Game& game = *owner;
+    Board start;
+    game.setPosition(start, true);
+    CHECK(game.getLegalMoves().size() == 20);
+    CHECK(game.applyMove(parseMove("e2e4")));
+    CHECK(game.getLegalMoves().size() == 20);
+    CHECK(!game.applyMove(parseMove("e7e4")));
+
+    // Kiwipete has 48 legal moves, castling both ways included
+    Board kiwipete;
+    FenState state;
+    CHECK(kiwipete.loadFEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", state));
+    game.setPosition(kiwipete, true);
+    CHECK(game.getLegalMoves().size() == 48);
+    CHECK(game.isLegalMove(7, 4, 7, 6));
+    CHECK(game.isLegalMove(7, 4, 7, 2));
+
+    // Fool's mate
+    game.setPosition(start, true);
+    CHECK(playMoves(game, "f2f3 e7e5 g2g4 d8h4"));
+    CHECK(game.getStatus() == GameStatus::Checkmate);
+    CHECK(game.getLegalMoves().empty());
+
+    // Promotion to a queen through movePiece
+    Board promotion;
+    CHECK(promotion.loadFEN("4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", state));
+    CHECK(promotion.movePiece(1, 1, 0, 1, true));
+    CHECK(promotion.getPiece(0, 1) && promotion.getPiece(0, 1)->getSymbol() == 'Q');
+    CHECK(!promotion.getPiece(1, 1));
+}
+
+static void testSee() {
+    Board board;
+    FenState state;
+
+    // Pawn takes an undefended knight
+    CHECK(board.loadFEN("4k3/8/3n4/4P3/8/8/8/4K3 w - - 0 1", state));
+    CHECK(board.staticExchange(3, 4, 2, 3) == Board::pieceValue('n'));
+
+    // Rook takes a pawn defended by a pawn
+    CHECK(board.loadFEN("4k3/8/2p5/3p4/8/8/8/3RK3 w - - 0 1", state));
+    CHECK(board.staticExchange(7, 3, 3, 3) == Board::pieceValue('p') - Board::pieceValue('R'));
+
+    // Knight takes a knight defended by a pawn: an even trade
+    CHECK(board.loadFEN("4k3/8/2p5/3n4/8/4N3/8/4K3 w - - 0 1", state));
+    CHECK(board.staticExchange(5, 4, 3, 3) == 0);
+}
+
+static void testRecord() {
+    Game game;
+    Board start;
+    game.setPosition(start, true);
+    CHECK(playMoves(game, "e2e4 c7c5 g1f3 d7d6 d2d4 c5d4 f3d4 g8f6 b1c3 a7a6"));
+
+    GameRecord record = game.getRecord();
+    CHECK(record.getPlyCount() == 10);
+    CHECK(record.hasStandardStart());
+    record.setResult(PgnResult::Draw);
+
+    // Moves only: 2 bytes plus 2 per ply
+    vector<uint8_t> bytes;
+    record.encode(bytes);
+    CHECK(bytes.size() == 2 + 2 * 10);
+
+    GameRecord decoded;
+    size_t used = 0;
+    CHECK(decoded.decode(bytes.data(), bytes.size(), &used));
+    CHECK(used == bytes.size());
+    CHECK(decoded.getPlyCount() == 10);
+    CHECK(decoded.getResult() == PgnResult::Draw);
+    for (int ply = 0; ply < 10; ++ply) {
+        CHECK(GameRecord::encodeMove(decoded.getMove(ply)) == GameRecord::encodeMove(record.getMove(ply)));
+    }
+    CHECK(decoded.toPgn() == record.toPgn());
+
+    char fen[Board::FEN_BUFFER_SIZE];
+    CHECK(decoded.fenAt(10, fen, sizeof(fen)) > 0);
+    CHECK(strcmp(fen, "rnbqkb1r/1p2pppp/p2p1n2/8/3NP3/2N5/PPP2PPP/R1BQKB1R w KQkq - 0 6") == 0);
+
+    // A custom start with evaluations and clocks, the first ply included
+    Board custom;
+    FenState state;
+    CHECK(custom.loadFEN("4k3/8/8/8/8/8/4P3/4K3 w - - 5 30", state));
+    GameRecord annotated;
+    annotated.reset(custom, true, state.halfmoveClock, state.fullmoveNumber);
+    annotated.addMove(parseMove("e2e4"), 150, 60000);
+    annotated.addMove(parseMove("e8d7"), GameRecord::NO_EVAL, 59000);
+    annotated.addMove(parseMove("e1e2"), -40000, 58000);
+    bytes.clear();
+    annotated.encode(bytes);
+    // Two records back to back are read one at a time
+    record.encode(bytes);
+
+    CHECK(decoded.decode(bytes.data(), bytes.size(), &used));
+    CHECK(!decoded.hasStandardStart());
+    CHECK(decoded.getPlyCount() == 3);
+    CHECK(decoded.getEval(0) == 150);
+    CHECK(decoded.getEval(1) == GameRecord::NO_EVAL);
+    CHECK(decoded.getEval(2) == -32767);  // clamped to 16 bits
+    CHECK(decoded.getClock(0) == 60000 && decoded.getClock(2) == 58000);
+    CHECK(decoded.fenAt(0, fen, sizeof(fen)) > 0);
+    CHECK(strcmp(fen, "4k3/8/8/8/8/8/4P3/4K3 w - - 5 30") == 0);
+
+    GameRecord second;
+    CHECK(second.decode(bytes.data() + used, bytes.size() - used));
+    CHECK(second.getPlyCount() == 10);
+}
+
+static void testRepetition() {
+    Game game;
+    Board start;
+    game.setPosition(start, true);
+    CHECK(playMoves(game, "g1f3 g8f6 f3g1 f6g8"));
+    CHECK(game.countRepetitions() == 2);
+    CHECK(!game.isThreefoldRepetition());
+    CHECK(playMoves(game, "g1f3 g8f6 f3g1 f6g8"));
+    CHECK(game.isThreefoldRepetition());
+    CHECK(game.getStatus() == GameStatus::ThreefoldRepetition);
+
+    // A pawn move makes the earlier positions unreachable
+    game.setPosition(start, true);
+    CHECK(playMoves(game, "g1f3 g8f6 f3g1 f6g8 e2e4 e7e5"));
+    CHECK(game.countRepetitions() == 1);
+    CHECK(game.getHalfmoveClock() == 0);
+
+    // The clock of a FEN carries on, so two quiet moves reach the fifty-move rule
+    Board endgame;
+    FenState state;
+    CHECK(endgame.loadFEN("4k3/8/8/8/8/8/8/R3K3 w - - 98 80", state));
+    game.setPosition(endgame, state.whiteTurn, state.halfmoveClock);
+    CHECK(game.getHalfmoveClock() == 98);
+    CHECK(playMoves(game, "a1a2 e8d8"));
+    CHECK(game.getHalfmoveClock() == 100);
+    CHECK(game.getStatus() == GameStatus::FiftyMoveRule);
+    game.setPosition(endgame, state.whiteTurn, state.halfmoveClock);
+    CHECK(playMoves(game, "a1a8"));
+    CHECK(game.getHalfmoveClock() == 99);
+}
+
+static void testSearch() {
+    Game game;
+    Board board;
+    FenState state;
+
+    // Back-rank mate in one, found with its distance
+    CHECK(board.loadFEN("6k1/5ppp/8/8/8/8/5PPP/3Q2K1 w - - 0 1", state));
+    game.setPosition(board, true);
+    SearchLimits limits;
+    limits.depth = 3;
+    SearchResult result = game.search(true, limits);
+    CHECK(Game::moveToUci(game.getBoard(), result.bestMove) == "d1d8");
+    CHECK(result.score == MATE_SCORE);
+    CHECK(result.mateIn == 1);
+
+    // Mated after any reply; the best of them, axb2, earns a capture bonus
+    // at the root that must not turn the mate into a centipawn score
+    CHECK(board.loadFEN("7k/5K2/8/6P1/8/p7/1N6/R7 b - - 0 1", state));
+    game.setPosition(board, false);
+    result = game.search(false, limits);
+    CHECK(result.bestMove.fromRow >= 0);
+    CHECK(result.score == -MATE_SCORE);
+    CHECK(result.mateIn == -1);
+}
+
+int main(int argc, char** argv) {
+    struct Group {
+        const char* name;
+        void (*run)();
+    };
+    const Group groups[] = {
+        { "fen", testFen },
+        { "legality", testLegality },
+        { "see", testSee },
+        { "record", testRecord },
+        { "repetition", testRepetition },
+        { "search", testSearch }
+    };
+
+    bool ran = false;
+    for (const Group& group : groups) {
+        if (argc > 1 && strcmp(argv[1], group.name) != 0) continue;
+        int before = failures;
+        group.run();
+        cout << group.name << ": " << (failures == before ? "ok" : "FAILED") << endl;
+        ran = true;
+    }
+    if (!ran) {
+        cerr << "Usage: EngineTests [fen | legality | see | record | repetition | search]" << endl;
+        return 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
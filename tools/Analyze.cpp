@@ -0,0 +1,221 @@
+// Batch analysis of FEN/EPD positions without the GUI.
+//
+// The position file is memory-mapped and handed out one line at a time to a
+// pool of threads; each thread owns its Game, so the caches and search state
+// are never shared. Every finished position is written as one line:
+//
+//   <line> <id> <bestmove> <score> <depth> <nodes> <ms> <pv...>
+//
+// EPD "bm" operations are checked against the engine's choice and the number
+// of solved positions is printed at the end.
+//
+// Usage: Analyze <positions.epd> [--threads N] [--depth N] [--movetime MS]
+//                [--nodes N] [--out FILE] [--tb DIR]
+//
+// --tb names the endgame table directory (default "tablebases").
+
+#include "Game.h"
+#include "MappedFile.h"
+#include "PgnReader.h"
+#include "Tablebase.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct Line {
+    size_t begin;
+    size_t end;
+};
+
+// Finds the EPD operation 'name' in ops text like: bm Qd1+ Nf3; id "WAC.001";
+// and returns its operands without the terminating semicolon.
+static bool findOperation(const char* ops, const char* opsEnd, const char* name, const char*& value, size_t& length) {
+    size_t nameLength = strlen(name);
+    const char* p = ops;
+    while (p < opsEnd) {
+        while (p < opsEnd && (*p == ' ' || *p == '\t' || *p == ';')) ++p;
+        const char* opStart = p;
+        while (p < opsEnd && *p != ' ' && *p != '\t' && *p != ';') ++p;
+        bool match = (size_t)(p - opStart) == nameLength && memcmp(opStart, name, nameLength) == 0;
+
+        while (p < opsEnd && (*p == ' ' || *p == '\t')) ++p;
+        const char* operands = p;
+        bool quoted = false;
+        while (p < opsEnd && (quoted || *p != ';')) {
+            if (*p == '"') quoted = !quoted;
+            ++p;
+        }
+        if (match) {
+            value = operands;
+            length = p - operands;
+            while (length > 0 && (value[length - 1] == ' ' || value[length - 1] == '\t')) --length;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Whether the engine's move is one of the SAN moves listed in a "bm" operation
+static bool isBestMove(const Board& board, bool whiteTurn, const SimpleMove& move, const char* list, size_t length) {
+    const char* p = list;
+    const char* end = list + length;
+    while (p < end) {
+        while (p < end && *p == ' ') ++p;
+        const char* san = p;
+        while (p < end && *p != ' ') ++p;
+        if (p == san) break;
+
+        Board copy = board;
+        SimpleMove expected = {};
+        if (PgnReader::playSan(copy, whiteTurn, san, p - san, expected) &&
+            expected.fromRow == move.fromRow && expected.fromCol == move.fromCol &&
+            expected.toRow == move.toRow && expected.toCol == move.toCol) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "Usage: Analyze <positions.epd> [--threads N] [--depth N] [--movetime MS] [--nodes N] [--out FILE] [--tb DIR]" << endl;
+        return 1;
+    }
+    string path = argv[1];
+    string outPath;
+    string tablebasePath = Tablebase::DEFAULT_DIRECTORY;
+    int threads = (int)thread::hardware_concurrency();
+    SearchLimits limits;
+    limits.depth = 6;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (arg == "--depth" && i + 1 < argc) limits.depth = atoi(argv[++i]);
+        else if (arg == "--movetime" && i + 1 < argc) limits.timeMs = atoi(argv[++i]);
+        else if (arg == "--nodes" && i + 1 < argc) limits.nodes = atoll(argv[++i]);
+        else if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else if (arg == "--tb" && i + 1 < argc) tablebasePath = argv[++i];
+    }
+    if (threads < 1) threads = 1;
+
+    MappedFile file;
+    if (!file.open(path)) {
+        cerr << "Could not map " << path << endl;
+        return 1;
+    }
+    ofstream outFile;
+    if (!outPath.empty()) {
+        outFile.open(outPath);
+        if (!outFile) {
+            cerr << "Could not write " << outPath << endl;
+            return 1;
+        }
+    }
+    ostream& out = outPath.empty() ? cout : outFile;
+
+    // Non-empty, non-comment lines
+    const char* text = reinterpret_cast<const char*>(file.data());
+    vector<Line> lines;
+    for (size_t begin = 0; begin < file.size();) {
+        size_t end = begin;
+        while (end < file.size() && text[end] != '\n') ++end;
+        size_t first = begin;
+        while (first < end && (text[first] == ' ' || text[first] == '\t' || text[first] == '\r')) ++first;
+        if (first < end && text[first] != '#') lines.push_back({ first, end });
+        begin = end + 1;
+    }
+
+    Tablebase::init(tablebasePath);
+
+    atomic<size_t> nextLine(0);
+    atomic<int> solved(0), withBestMove(0), malformed(0);
+    atomic<long long> totalNodes(0);
+    mutex outputMutex;
+    auto start = chrono::steady_clock::now();
+
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            Game game;
+            Board position;
+            string fen;
+            string output;
+            for (size_t index = nextLine++; index < lines.size(); index = nextLine++) {
+                // Copied out, whole, because the mapped text is not NUL-terminated
+                const Line& line = lines[index];
+                size_t length = line.end - line.begin;
+                while (length > 0 && (text[line.begin + length - 1] == '\r' || text[line.begin + length - 1] == ' ')) --length;
+                fen.assign(text + line.begin, length);
+
+                FenState state;
+                const char* opsStart = fen.c_str();
+                if (!position.loadFEN(fen.c_str(), state, &opsStart)) {
+                    ++malformed;
+                    lock_guard<mutex> lock(outputMutex);
+                    cerr << "Line " << index + 1 << ": malformed FEN" << endl;
+                    continue;
+                }
+                const char* opsEnd = fen.c_str() + fen.size();
+                // A fresh game history, so status and repetitions belong to this position
+                game.setPosition(position, state.whiteTurn, state.halfmoveClock);
+
+                string id = to_string(index + 1);
+                const char* value;
+                size_t valueLength;
+                if (findOperation(opsStart, opsEnd, "id", value, valueLength)) {
+                    if (valueLength >= 2 && value[0] == '"' && value[valueLength - 1] == '"') {
+                        ++value;
+                        valueLength -= 2;
+                    }
+                    id.assign(value, valueLength);
+                }
+
+                SearchResult result = game.search(state.whiteTurn, limits);
+                totalNodes += result.nodes;
+
+                const Board& board = game.getBoard();
+                bool hasMove = result.bestMove.fromRow >= 0;
+                if (findOperation(opsStart, opsEnd, "bm", value, valueLength)) {
+                    ++withBestMove;
+                    if (hasMove && isBestMove(board, state.whiteTurn, result.bestMove, value, valueLength)) ++solved;
+                }
+
+                output = to_string(index + 1) + ' ' + id + ' ';
+                output += hasMove ? Game::moveToUci(board, result.bestMove) : "(none)";
+                output += ' ' + to_string(result.score) + ' ' + to_string(result.depth) + ' ' +
+                    to_string(result.nodes) + ' ' + to_string((long long)(result.seconds * 1000));
+
+                // The PV is replayed on a scratch board so promotions are spelled correctly
+                Board scratch = board;
+                bool white = state.whiteTurn;
+                for (const SimpleMove& m : result.pv) {
+                    output += ' ' + Game::moveToUci(scratch, m);
+                    if (!scratch.playMove(m.fromRow, m.fromCol, m.toRow, m.toCol, white)) break;
+                    white = !white;
+                }
+                output += '\n';
+
+                lock_guard<mutex> lock(outputMutex);
+                out << output << flush;
+            }
+        });
+    }
+    for (thread& worker : workers) worker.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cerr << "Positions: " << lines.size() - malformed << " (" << malformed << " malformed)" << endl;
+    if (withBestMove > 0) cerr << "Solved:    " << solved << " / " << withBestMove << endl;
+    cerr << "Nodes:     " << totalNodes << ", " << (long long)(totalNodes / (seconds > 0 ? seconds : 1))
+        << " nodes/s, " << threads << " threads, " << seconds << " s" << endl;
+    return 0;
+}
@@ -0,0 +1,303 @@
+// Micro-benchmarks of the engine's hot paths over a corpus of positions.
+//
+// Each benchmark repeats one operation, cycling through the corpus, until
+// the time budget is used, and reports nanoseconds and heap allocations
+// per operation. Allocations are counted by replacing the global operator
+// new of this program, which is also installed as the engine's
+// AllocationCounter. The search benchmark runs one findBestMove (depth 4, no
+// opening book) per position with a cleared transposition table; applyMove
+// plays every legal move of the corpus through Game, status refresh included.
+//
+// movePiece is measured together with restoring the board by assignment;
+// subtract board_assign for the move alone. evaluateBoard runs with a
+// one-slot evaluation cache, so every call evaluates, and
+// evaluateBoard_cached shows the cache hit path.
+//
+// Usage: Bench [--corpus FILE] [--time MS] [--filter TEXT] [--json]
+//
+// A corpus file holds one FEN per line; lines starting with '#' are skipped.
+// Output is CSV (benchmark,iterations,ns_per_op,allocs_per_op) or JSON.
+
+#include "Game.h"
+#include "AllocationCounter.h"
+#include "Moves.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Heap allocations so far, counted by the operator new of BenchAllocations.cpp
+long long benchAllocationCount();
+
+static const char* DEFAULT_CORPUS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "r1bqk1nr/pppp1ppp/2n5/2b1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "r1bq1rk1/pp1nbppp/2p1pn2/3p2B1/2PP4/2NBPN2/PP3PPP/R2QK2R w KQ - 0 8",
+    "r1b1kb1r/1pqp1ppp/p1n1pn2/8/3NP3/2N1B3/PPP1BPPP/R2QK2R w KQkq - 4 8",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3Q2K1 w - - 0 1",
+    "8/8/4k3/8/2P5/4K3/8/8 w - - 0 1",
+    "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3"
+};
+
+struct Position {
+    Board board;
+    FenState state;
+    vector<SimpleMove> moves;  // legal moves
+    vector<Move> records;      // the same moves as PGN move records
+};
+
+struct Result {
+    string name;
+    long long iterations;
+    double nsPerOp;
+    double allocsPerOp;
+};
+
+static volatile long long sink = 0;
+
+// Runs 'op' in batches until the budget is spent; op(i) performs the i-th operation
+static Result runBench(const string& name, double budgetMs, const function<void(long long)>& op) {
+    op(0);  // warm up caches and lazily built tables
+    long long iterations = 0;
+    long long allocations = 0;
+    double elapsedNs = 0;
+    long long batch = 16;
+    while (elapsedNs < budgetMs * 1e6) {
+        long long allocationsBefore = benchAllocationCount();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (long long i = 0; i < batch; ++i) op(iterations + i);
+        elapsedNs += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        allocations += benchAllocationCount() - allocationsBefore;
+        iterations += batch;
+        if (batch < (1 << 20)) batch *= 2;
+    }
+    return { name, iterations, elapsedNs / iterations, (double)allocations / iterations };
+}
+
+static Move makeRecord(Board& board, bool white, const SimpleMove& m) {
+    Piece* piece = board.getPiece(m.fromRow, m.fromCol);
+    char symbol = piece ? piece->getSymbol() : '?';
+    bool capture = board.getPiece(m.toRow, m.toCol) != nullptr ||
+        (toupper(symbol) == 'P' && m.fromCol != m.toCol);
+    bool castle = toupper(symbol) == 'K' && abs(m.toCol - m.fromCol) == 2;
+    Board after = board;
+    after.playMove(m.fromRow, m.fromCol, m.toRow, m.toCol, white);
+    return {
+        white ? "White" : "Black",
+        string(1, 'A' + m.fromCol) + to_string(8 - m.fromRow),
+        string(1, 'A' + m.toCol) + to_string(8 - m.toRow),
+        symbol,
+        capture,
+        false,
+        board.isPromotionMove(m.fromRow, m.fromCol, m.toRow, m.toCol, white),
+        'Q',
+        after.isInCheck(!white),
+        after.isCheckmate(!white),
+        castle && m.toCol > m.fromCol,
+        castle && m.toCol < m.fromCol,
+        false,
+        false
+    };
+}
+
+static bool loadCorpus(const string& path, vector<string>& fens) {
+    ifstream in(path);
+    if (!in) return false;
+    string line;
+    while (getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty() && line[0] != '#') fens.push_back(line);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    AllocationCounter::install(benchAllocationCount);
+
+    string corpusPath, filter;
+    double budgetMs = 300;
+    bool json = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--corpus" && hasValue) corpusPath = argv[++i];
+        else if (arg == "--time" && hasValue) budgetMs = atof(argv[++i]);
+        else if (arg == "--filter" && hasValue) filter = argv[++i];
+        else if (arg == "--json") json = true;
+        else {
+            cerr << "Usage: Bench [--corpus FILE] [--time MS] [--filter TEXT] [--json]" << endl;
+            return 1;
+        }
+    }
+
+    vector<string> fens;
+    if (corpusPath.empty()) {
+        fens.assign(begin(DEFAULT_CORPUS), end(DEFAULT_CORPUS));
+    }
+    else if (!loadCorpus(corpusPath, fens)) {
+        cerr << "Cannot read " << corpusPath << endl;
+        return 1;
+    }
+
+    // Positions with their legal moves, as generated by Game
+    vector<Position> corpus;
+    vector<pair<int, int>> movePairs;  // (position, move) for the move benchmarks
+    Game game;
+    for (const string& fen : fens) {
+        Position position;
+        if (!position.board.loadFEN(fen.c_str(), position.state)) {
+            cerr << "Skipping bad FEN: " << fen << endl;
+            continue;
+        }
+        game.setPosition(position.board, position.state.whiteTurn, position.state.halfmoveClock);
+        for (const SimpleMove& m : game.getLegalMoves()) {
+            position.moves.push_back(m);
+            position.records.push_back(makeRecord(position.board, position.state.whiteTurn, m));
+            movePairs.push_back({ (int)corpus.size(), (int)position.moves.size() - 1 });
+        }
+        corpus.push_back(move(position));
+    }
+    if (corpus.empty() || movePairs.empty()) {
+        cerr << "The corpus has no playable positions" << endl;
+        return 1;
+    }
+    long long n = (long long)corpus.size();
+
+    vector<Result> results;
+    auto wanted = [&](const string& name) { return filter.empty() || name.find(filter) != string::npos; };
+    auto bench = [&](const string& name, const function<void(long long)>& op) {
+        if (wanted(name)) results.push_back(runBench(name, budgetMs, op));
+    };
+
+    bench("board_copy", [&](long long i) {
+        Board copy(corpus[i % n].board);
+        sink += copy.getPiece(0, 0) != nullptr;
+    });
+
+    Board scratch;
+    bench("board_assign", [&](long long i) {
+        scratch = corpus[i % n].board;
+        sink += scratch.getPiece(0, 0) != nullptr;
+    });
+
+    bench("movePiece", [&](long long i) {
+        const pair<int, int>& pair = movePairs[i % movePairs.size()];
+        Position& position = corpus[pair.first];
+        const SimpleMove& m = position.moves[pair.second];
+        scratch = position.board;
+        sink += scratch.movePiece(m.fromRow, m.fromCol, m.toRow, m.toCol, position.state.whiteTurn);
+    });
+
+    bench("isInCheck", [&](long long i) {
+        Position& position = corpus[i % n];
+        sink += position.board.isInCheck(position.state.whiteTurn);
+    });
+
+    bench("isCheckmate", [&](long long i) {
+        Position& position = corpus[i % n];
+        sink += position.board.isCheckmate(position.state.whiteTurn);
+    });
+
+    bench("generateFEN", [&](long long i) {
+        Position& position = corpus[i % n];
+        sink += position.board.generateFEN(position.state.whiteTurn, true, true, true, true,
+            position.state.halfmoveClock, position.state.fullmoveNumber).size();
+    });
+
+    bench("getSimplePosition", [&](long long i) {
+        Position& position = corpus[i % n];
+        sink += position.board.getSimplePosition(position.state.whiteTurn).size();
+    });
+
+    bench("Move_toPGN", [&](long long i) {
+        const pair<int, int>& pair = movePairs[i % movePairs.size()];
+        sink += corpus[pair.first].records[pair.second].toPGN().size();
+    });
+
+    // One cache slot: consecutive corpus positions evict each other
+    Game evaluator;
+    evaluator.setEvalCacheSize(0);
+    bench("evaluateBoard", [&](long long i) {
+        Position& position = corpus[i % n];
+        sink += evaluator.evaluateBoard(position.board, position.state.whiteTurn);
+    });
+
+    Game cachedEvaluator;
+    bench("evaluateBoard_cached", [&](long long i) {
+        Position& position = corpus[i % n];
+        sink += cachedEvaluator.evaluateBoard(position.board, position.state.whiteTurn);
+    });
+
+    // Every legal move once, from a fresh game at its position; Game reports the move's allocations
+    if (wanted("applyMove")) {
+        Game player;
+        double totalNs = 0;
+        long long allocations = 0;
+        for (const pair<int, int>& pair : movePairs) {
+            Position& position = corpus[pair.first];
+            player.setPosition(position.board, position.state.whiteTurn, position.state.halfmoveClock);
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            sink += player.applyMove(position.moves[pair.second]);
+            totalNs += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+            allocations += player.getMoveAllocations();
+        }
+        long long played = (long long)movePairs.size();
+        results.push_back({ "applyMove", played, totalNs / played, (double)allocations / played });
+    }
+
+    // One search per position; findBestMove's console output is discarded
+    if (wanted("findBestMove")) {
+        Game searcher;
+        stringstream discard;
+        double totalNs = 0;
+        long long allocations = 0;
+        for (Position& position : corpus) {
+            if (position.moves.empty()) continue;
+            searcher.setPosition(position.board, position.state.whiteTurn, position.state.halfmoveClock);
+            searcher.getTranspositionTable()->clear();
+            streambuf* console = cout.rdbuf(discard.rdbuf());
+            long long allocationsBefore = benchAllocationCount();
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            string best = searcher.findBestMove(position.state.whiteTurn);
+            totalNs += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+            allocations += benchAllocationCount() - allocationsBefore;
+            cout.rdbuf(console);
+            discard.str("");
+            sink += best.size();
+        }
+        long long searched = 0;
+        for (const Position& position : corpus) searched += !position.moves.empty();
+        results.push_back({ "findBestMove", searched, totalNs / searched, (double)allocations / searched });
+    }
+
+    if (json) {
+        printf("{\n  \"positions\": %lld,\n  \"benchmarks\": [\n", n);
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            printf("    { \"name\": \"%s\", \"iterations\": %lld, \"ns_per_op\": %.1f, \"allocs_per_op\": %.2f }%s\n",
+                r.name.c_str(), r.iterations, r.nsPerOp, r.allocsPerOp, i + 1 < results.size() ? "," : "");
+        }
+        printf("  ]\n}\n");
+    }
+    else {
+        printf("benchmark,iterations,ns_per_op,allocs_per_op\n");
+        for (const Result& r : results) {
+            printf("%s,%lld,%.1f,%.2f\n", r.name.c_str(), r.iterations, r.nsPerOp, r.allocsPerOp);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,28 @@
+// Global allocation counting for the Bench tool. The replacement operator
+// new and delete live in their own translation unit so the compiler never
+// sees a new-expression and the free() behind its delete together, which
+// GCC would report as a mismatched allocation.
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long long> allocationCount(0);
+
+long long benchAllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
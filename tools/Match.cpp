@@ -0,0 +1,315 @@
+// Self-play match between two engine configurations.
+//
+// Games are played concurrently, one per thread, from openings taken from a
+// book file (FEN/EPD lines or a PGN file, whose final positions are used).
+// Every opening is played twice with colours reversed. Each side has its own
+// Game, so caches are not shared, and both follow every move so that Game's
+// draw rules (threefold repetition, fifty moves, insufficient material,
+// stalemate) adjudicate the result. Clocks are kept per side; overstepping
+// the clock loses.
+//
+// After every game the score of A against B is turned into an Elo estimate
+// and a sequential probability ratio test of elo0 against elo1; the match
+// stops as soon as the test accepts either hypothesis or the game limit is
+// reached.
+//
+// Usage: Match <book> [--games N] [--threads N] [--tc SECONDS+INC]
+//              [--a CONFIG] [--b CONFIG] [--sprt ELO0 ELO1] [--maxplies N]
+//              [--records FILE] [--tb DIR]
+//
+// With --records every finished game is appended to FILE as a GameRecord,
+// with the mover's score and remaining clock on each ply. --tb names the
+// endgame table directory (default "tablebases").
+//
+// CONFIG is a comma-separated list of depth=N, nodes=N, movetime=MS, hash=MB,
+// for example --a depth=6 --b depth=5,hash=32.
+
+#include "Game.h"
+#include "GameRecord.h"
+#include "MappedFile.h"
+#include "PgnReader.h"
+#include "Tablebase.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct EngineConfig {
+    SearchLimits limits;
+    size_t hashMb = 0;  // 0 = Game's default transposition table
+};
+
+struct Opening {
+    Board board;
+    bool whiteTurn;
+    int halfmoveClock = 0;
+    int fullmoveNumber = 1;
+};
+
+enum class Outcome { WinA, Draw, WinB };
+
+// Parses "depth=6,nodes=100000,movetime=500,hash=16"
+static bool parseConfig(const string& text, EngineConfig& config) {
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = text.find(',', begin);
+        if (end == string::npos) end = text.size();
+        string item = text.substr(begin, end - begin);
+        size_t eq = item.find('=');
+        if (eq == string::npos) return false;
+        string key = item.substr(0, eq);
+        long long value = atoll(item.c_str() + eq + 1);
+        if (key == "depth") config.limits.depth = (int)value;
+        else if (key == "nodes") config.limits.nodes = value;
+        else if (key == "movetime") config.limits.timeMs = (int)value;
+        else if (key == "hash") config.hashMb = (size_t)value;
+        else return false;
+        begin = end + 1;
+    }
+    return true;
+}
+
+static bool loadBook(const string& path, vector<Opening>& openings) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+    const char* text = reinterpret_cast<const char*>(file.data());
+
+    if (path.size() > 4 && path.compare(path.size() - 4, 4, ".pgn") == 0) {
+        PgnReader reader;
+        reader.attach(text, file.size());
+        PgnGame game;
+        while (reader.nextGame(game)) {
+            if (!game.error) openings.push_back({ game.board, game.whiteTurn, 0, 1 + game.plyCount / 2 });
+        }
+        return true;
+    }
+
+    char fen[256];
+    for (size_t begin = 0; begin < file.size();) {
+        size_t end = begin;
+        while (end < file.size() && text[end] != '\n') ++end;
+        size_t length = min(end - begin, sizeof(fen) - 1);
+        memcpy(fen, text + begin, length);
+        fen[length] = '\0';
+        begin = end + 1;
+        if (length == 0 || fen[0] == '#' || fen[0] == '\r') continue;
+
+        Opening opening;
+        FenState state;
+        if (opening.board.loadFEN(fen, state)) {
+            opening.whiteTurn = state.whiteTurn;
+            opening.halfmoveClock = state.halfmoveClock;
+            opening.fullmoveNumber = state.fullmoveNumber;
+            openings.push_back(opening);
+        }
+    }
+    return true;
+}
+
+// Score of a result set as a fraction, and its per-game variance
+static void scoreStats(long long wins, long long draws, long long losses, double& score, double& variance) {
+    double n = (double)(wins + draws + losses);
+    score = (wins + 0.5 * draws) / n;
+    variance = (wins * (1 - score) * (1 - score) + draws * (0.5 - score) * (0.5 - score) +
+        losses * score * score) / n;
+}
+
+static double eloToScore(double elo) { return 1.0 / (1.0 + pow(10.0, -elo / 400.0)); }
+static double scoreToElo(double score) {
+    score = min(max(score, 1e-6), 1 - 1e-6);
+    return -400.0 * log10(1.0 / score - 1.0);
+}
+
+// Log-likelihood ratio of elo1 against elo0 under a normal approximation
+// of the trinomial game results
+static double sprtLlr(long long wins, long long draws, long long losses, double elo0, double elo1) {
+    double score, variance;
+    scoreStats(wins, draws, losses, score, variance);
+    if (variance <= 0.0) return 0.0;  // all results equal, nothing to measure yet
+    double n = (double)(wins + draws + losses);
+    double s0 = eloToScore(elo0), s1 = eloToScore(elo1);
+    return n * (s1 - s0) * (2 * score - s0 - s1) / (2 * variance);
+}
+
+// Plays one game into 'record'; A has white when aWhite is set
+static Outcome playGame(const Opening& opening, bool aWhite, const EngineConfig configs[2],
+    Game engines[2], int baseMs, int incMs, int maxPlies, GameRecord& record) {
+    for (int e = 0; e < 2; ++e) {
+        engines[e].setPosition(opening.board, opening.whiteTurn, opening.halfmoveClock);
+    }
+    record.reset(opening.board, opening.whiteTurn, opening.halfmoveClock, opening.fullmoveNumber);
+
+    long long clock[2] = { baseMs, baseMs };  // indexed by engine
+    bool white = opening.whiteTurn;
+    for (int ply = 0; ply < maxPlies; ++ply) {
+        GameStatus status = engines[0].getStatus();
+        if (status == GameStatus::Checkmate) {
+            // The side to move is mated
+            return (white == aWhite) ? Outcome::WinB : Outcome::WinA;
+        }
+        if (engines[0].isGameOver()) return Outcome::Draw;
+
+        int mover = (white == aWhite) ? 0 : 1;
+        SearchLimits limits = configs[mover].limits;
+        if (baseMs > 0) {
+            // A fixed share of the remaining time plus the increment
+            long long budget = clock[mover] / 30 + incMs;
+            budget = min(budget, clock[mover] - 10);
+            if (budget < 1) budget = 1;
+            if (limits.timeMs == 0 || limits.timeMs > budget) limits.timeMs = (int)budget;
+        }
+
+        SearchResult result = engines[mover].search(white, limits);
+        if (baseMs > 0) {
+            clock[mover] -= (long long)(result.seconds * 1000.0);
+            if (clock[mover] < 0) return mover == 0 ? Outcome::WinB : Outcome::WinA;
+            clock[mover] += incMs;
+        }
+        const SimpleMove& m = result.bestMove;
+        if (m.fromRow < 0) return Outcome::Draw;  // cannot happen while the game is in progress
+        record.addMove(m, result.score, baseMs > 0 ? (int)clock[mover] : GameRecord::NO_CLOCK);
+
+        for (int e = 0; e < 2; ++e) {
+            if (!engines[e].applyMove(m)) {
+                return e == mover ? (mover == 0 ? Outcome::WinB : Outcome::WinA) : Outcome::Draw;
+            }
+        }
+        white = !white;
+    }
+    return Outcome::Draw;  // adjudicated on length
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "Usage: Match <book> [--games N] [--threads N] [--tc SECONDS+INC] [--a CONFIG] [--b CONFIG]"
+            " [--sprt ELO0 ELO1] [--maxplies N] [--records FILE] [--tb DIR]" << endl;
+        return 1;
+    }
+    string bookPath = argv[1];
+    int games = 1000;
+    int threads = (int)thread::hardware_concurrency();
+    int baseMs = 0, incMs = 0;
+    int maxPlies = 400;
+    string recordsPath;
+    string tablebasePath = Tablebase::DEFAULT_DIRECTORY;
+    double elo0 = 0.0, elo1 = 5.0;
+    const double alpha = 0.05, beta = 0.05;
+    EngineConfig configs[2];
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--games" && hasValue) games = atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) threads = atoi(argv[++i]);
+        else if (arg == "--maxplies" && hasValue) maxPlies = atoi(argv[++i]);
+        else if (arg == "--records" && hasValue) recordsPath = argv[++i];
+        else if (arg == "--tb" && hasValue) tablebasePath = argv[++i];
+        else if (arg == "--tc" && hasValue) {
+            string tc = argv[++i];
+            size_t plus = tc.find('+');
+            baseMs = (int)(atof(tc.c_str()) * 1000);
+            incMs = plus == string::npos ? 0 : (int)(atof(tc.c_str() + plus + 1) * 1000);
+        }
+        else if ((arg == "--a" || arg == "--b") && hasValue) {
+            if (!parseConfig(argv[++i], configs[arg == "--a" ? 0 : 1])) {
+                cerr << "Bad engine configuration: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--sprt" && i + 2 < argc) {
+            elo0 = atof(argv[++i]);
+            elo1 = atof(argv[++i]);
+        }
+    }
+    if (threads < 1) threads = 1;
+
+    vector<Opening> openings;
+    if (!loadBook(bookPath, openings) || openings.empty()) {
+        cerr << "No openings in " << bookPath << endl;
+        return 1;
+    }
+
+    FILE* records = nullptr;
+    if (!recordsPath.empty()) {
+        records = fopen(recordsPath.c_str(), "ab");
+        if (!records) {
+            cerr << "Cannot open " << recordsPath << endl;
+            return 1;
+        }
+    }
+
+    Tablebase::init(tablebasePath);
+
+    double lowerBound = log(beta / (1 - alpha));
+    double upperBound = log((1 - beta) / alpha);
+    cout << "Openings: " << openings.size() << ", games: " << games << ", threads: " << threads
+        << ", SPRT elo0 " << elo0 << " elo1 " << elo1 << " bounds [" << lowerBound << ", " << upperBound << "]" << endl;
+
+    atomic<int> nextGame(0);
+    atomic<bool> finished(false);
+    mutex resultMutex;
+    long long wins = 0, draws = 0, losses = 0;  // from A's point of view
+    string verdict;
+
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            Game engines[2];
+            GameRecord record;
+            vector<uint8_t> encoded;
+            for (int e = 0; e < 2; ++e) {
+                if (configs[e].hashMb > 0) engines[e].setHashSize(configs[e].hashMb);
+            }
+            for (int index = nextGame++; index < games && !finished; index = nextGame++) {
+                const Opening& opening = openings[(index / 2) % openings.size()];
+                bool aWhite = index % 2 == 0;
+                Outcome outcome = playGame(opening, aWhite, configs, engines, baseMs, incMs, maxPlies, record);
+                if (records) {
+                    bool whiteWon = (outcome == Outcome::WinA) == aWhite;
+                    record.setResult(outcome == Outcome::Draw ? PgnResult::Draw
+                        : whiteWon ? PgnResult::WhiteWins : PgnResult::BlackWins);
+                    encoded.clear();
+                    record.encode(encoded);
+                }
+
+                lock_guard<mutex> lock(resultMutex);
+                if (finished) return;
+                if (records) fwrite(encoded.data(), 1, encoded.size(), records);
+                if (outcome == Outcome::WinA) ++wins;
+                else if (outcome == Outcome::WinB) ++losses;
+                else ++draws;
+
+                long long played = wins + draws + losses;
+                double score, variance;
+                scoreStats(wins, draws, losses, score, variance);
+                double margin = 1.96 * sqrt(variance / played);
+                double llr = sprtLlr(wins, draws, losses, elo0, elo1);
+                char line[160];
+                snprintf(line, sizeof(line), "Game %lld: +%lld =%lld -%lld  Elo %.1f +/- %.1f  LLR %.2f\n",
+                    played, wins, draws, losses, scoreToElo(score),
+                    (scoreToElo(score + margin) - scoreToElo(score - margin)) / 2, llr);
+                fputs(line, stdout);
+                fflush(stdout);
+
+                if (llr >= upperBound) verdict = "H1 accepted: A is stronger by at least elo1";
+                else if (llr <= lowerBound) verdict = "H0 accepted: A is not stronger by elo1";
+                if (!verdict.empty()) finished = true;
+            }
+        });
+    }
+    for (thread& worker : workers) worker.join();
+    if (records) fclose(records);
+
+    cout << "Final: +" << wins << " =" << draws << " -" << losses << ", "
+        << (verdict.empty() ? "SPRT inconclusive" : verdict) << endl;
+    return 0;
+}
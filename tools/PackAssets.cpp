@@ -0,0 +1,41 @@
+// Packs the GUI's assets into one file for AssetPack.
+//
+// Usage: PackAssets <output.pack> <file>...
+//
+// Each file is stored under its file name without directories, which is
+// the name the game looks it up by (wp.png, arial.ttf, ...).
+
+#include "AssetPack.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        cerr << "Usage: PackAssets <output.pack> <file>..." << endl;
+        return 1;
+    }
+
+    vector<string> names, files;
+    for (int i = 2; i < argc; ++i) {
+        string file = argv[i];
+        size_t slash = file.find_last_of("/\\");
+        names.push_back(slash == string::npos ? file : file.substr(slash + 1));
+        files.push_back(file);
+    }
+
+    if (!AssetPack::write(argv[1], names, files)) {
+        cerr << "Failed to write " << argv[1] << endl;
+        return 1;
+    }
+
+    AssetPack pack;
+    if (!pack.open(argv[1]) || pack.getCount() != files.size()) {
+        cerr << "Written pack does not read back: " << argv[1] << endl;
+        return 1;
+    }
+    cout << "Packed " << files.size() << " assets into " << argv[1] << endl;
+    return 0;
+}
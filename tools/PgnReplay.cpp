@@ -0,0 +1,104 @@
+// Replays every game of a PGN database through the engine's move rules.
+//
+// The file is memory-mapped once and split into byte ranges, one per
+// thread; each thread runs its own PgnReader over its range and resolves
+// every SAN move against the board. Prints game, ply and result counts,
+// games that failed to replay, and the throughput.
+//
+// Usage: PgnReplay <games.pgn> [--threads N] [--no-replay] [--errors]
+
+#include "PgnReader.h"
+#include "MappedFile.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct ShardStats {
+    long long games = 0;
+    long long plies = 0;
+    long long errors = 0;
+    long long results[4] = { 0, 0, 0, 0 };  // indexed by PgnResult
+};
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "Usage: PgnReplay <games.pgn> [--threads N] [--no-replay] [--errors]" << endl;
+        return 1;
+    }
+    string path = argv[1];
+    int threads = (int)thread::hardware_concurrency();
+    bool replay = true;
+    bool showErrors = false;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (arg == "--no-replay") replay = false;
+        else if (arg == "--errors") showErrors = true;
+    }
+    if (threads < 1) threads = 1;
+
+    MappedFile file;
+    if (!file.open(path)) {
+        cerr << "Could not map " << path << endl;
+        return 1;
+    }
+    const char* text = reinterpret_cast<const char*>(file.data());
+    vector<size_t> bounds = PgnReader::shardBoundaries(file.size(), threads);
+
+    auto start = chrono::steady_clock::now();
+    vector<ShardStats> stats(threads);
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            PgnReader reader;
+            reader.attach(text, file.size());
+            reader.setRange(bounds[t], bounds[t + 1]);
+            reader.setReplay(replay);
+
+            PgnGame game;
+            ShardStats& s = stats[t];
+            while (reader.nextGame(game)) {
+                ++s.games;
+                s.plies += game.plyCount;
+                ++s.results[(int)game.result];
+                if (game.error) {
+                    ++s.errors;
+                    if (showErrors) {
+                        char line[96];
+                        snprintf(line, sizeof(line), "Replay failed at ply %d of the game at byte %zu\n",
+                            game.errorPly, game.offset);
+                        fputs(line, stderr);
+                    }
+                }
+            }
+        });
+    }
+    for (thread& worker : workers) worker.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    ShardStats total;
+    for (const ShardStats& s : stats) {
+        total.games += s.games;
+        total.plies += s.plies;
+        total.errors += s.errors;
+        for (int i = 0; i < 4; ++i) total.results[i] += s.results[i];
+    }
+
+    cout << "Games:   " << total.games << " (" << total.errors << " failed to replay)" << endl;
+    cout << "Plies:   " << total.plies << endl;
+    cout << "Results: 1-0 " << total.results[(int)PgnResult::WhiteWins]
+        << ", 0-1 " << total.results[(int)PgnResult::BlackWins]
+        << ", 1/2 " << total.results[(int)PgnResult::Draw]
+        << ", * " << total.results[(int)PgnResult::Unknown] << endl;
+    cout << "Time:    " << seconds << " s, " << (long long)(total.games / (seconds > 0 ? seconds : 1))
+        << " games/s, " << (long long)(total.plies / (seconds > 0 ? seconds : 1)) << " plies/s, "
+        << threads << " threads" << endl;
+    return 0;
+}
@@ -0,0 +1,38 @@
+// Builds the endgame tables probed by Tablebase (KQvK, KRvK and KPvK) by
+// retrograde analysis and writes them into a directory. The engine maps
+// them from "tablebases" next to the working directory at startup.
+//
+// Usage: TablebaseGen [directory]
+
+#include "Tablebase.h"
+#include "Board.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    string directory = argc > 1 ? argv[1] : Tablebase::DEFAULT_DIRECTORY;
+
+    auto start = chrono::steady_clock::now();
+    if (!Tablebase::generate(directory)) {
+        cerr << "Could not write tables to " << directory << " (does the directory exist?)" << endl;
+        return 1;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    int mapped = Tablebase::init(directory);
+    cout << "Generated " << mapped << " tables in " << directory << " (" << seconds << " s)" << endl;
+
+    // Sanity check: KQvK with the queen side to move is a win
+    Board board;
+    bool whiteTurn = true;
+    TablebaseResult result;
+    if (!board.loadFEN("4k3/8/4K3/8/8/8/8/7Q w - - 0 1", whiteTurn) ||
+        !Tablebase::probe(board, whiteTurn, result) || result.wdl != 1) {
+        cerr << "Generated tables failed the sanity probe" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,382 @@
+// Offline Texel tuner for the evaluation weights in Chess/EvalWeights.h.
+//
+// Reads a corpus of positions labelled with game results (one FEN/EPD per
+// line followed by 1-0, 0-1, 1/2-1/2 or [1.0]/[0.5]/[0.0]), extracts the
+// evaluation features once in parallel, then minimises the mean squared
+// error between the game result and sigmoid(eval) with Adam. The evaluation
+// is linear in the tuned weights, so every position is stored as a short
+// sparse list of (weight index, coefficient) pairs and the loss is computed
+// in batches across all cores.
+//
+// Usage: Tuner <corpus> [--threads N] [--epochs N] [--batch N] [--rate X]
+//              [--k X] [--out FILE]
+
+#include "Game.h"
+#include "Board.h"
+#include "EvalWeights.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Weight layout: 6 piece-square tables, then the scalar weights
+static const int PST_WEIGHTS = 6 * 64;
+static const int W_MOBILITY = PST_WEIGHTS + 0;
+static const int W_CENTER = PST_WEIGHTS + 1;
+static const int W_DEVELOPMENT = PST_WEIGHTS + 2;
+static const int W_CASTLED = PST_WEIGHTS + 3;
+static const int W_CHECK = PST_WEIGHTS + 4;
+static const int WEIGHT_COUNT = PST_WEIGHTS + 5;
+
+static const int (*const initialTables[6])[8] = {
+    pawnTable, knightTable, bishopTable, rookTable, queenTable, kingTable
+};
+static const char* tableNames[6] = {
+    "pawnTable", "knightTable", "bishopTable", "rookTable", "queenTable", "kingTable"
+};
+
+// Sparse, structure-of-arrays storage for the whole corpus
+struct Dataset {
+    vector<float> result;      // 1 = white won, 0.5 = draw, 0 = black won
+    vector<float> base;        // untuned part of the evaluation (material, pawn structure)
+    vector<uint32_t> begin;    // first term of each position; begin[n] is the end
+    vector<uint16_t> index;
+    vector<int16_t> coef;
+
+    Dataset() { begin.push_back(0); }
+    size_t size() const { return result.size(); }
+
+    void append(const Dataset& other) {
+        uint32_t offset = (uint32_t)index.size();
+        result.insert(result.end(), other.result.begin(), other.result.end());
+        base.insert(base.end(), other.base.begin(), other.base.end());
+        for (size_t i = 1; i < other.begin.size(); ++i) begin.push_back(other.begin[i] + offset);
+        index.insert(index.end(), other.index.begin(), other.index.end());
+        coef.insert(coef.end(), other.coef.begin(), other.coef.end());
+    }
+};
+
+struct Options {
+    string corpus;
+    string out = "EvalWeightsTuned.h";
+    int threads = 0;
+    int epochs = 200;
+    size_t batch = 65536;
+    double rate = 1.0;
+    double k = 0.0;  // 0 = search for the best scale first
+};
+
+// Runs fn(thread, begin, end) over [0, count) split evenly across threads
+template <typename Fn>
+static void parallelFor(int threads, size_t count, Fn fn) {
+    vector<thread> workers;
+    size_t chunk = (count + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t) {
+        size_t from = t * chunk, to = min(count, from + chunk);
+        if (from >= to) break;
+        workers.emplace_back(fn, t, from, to);
+    }
+    for (thread& worker : workers) worker.join();
+}
+
+// Parses the game result that follows the first four FEN fields, -1 if none
+static float parseResult(const char* line, const char* end) {
+    const char* p = line;
+    for (int field = 0; field < 4 && p < end; ++field) {
+        while (p < end && isspace((unsigned char)*p)) ++p;
+        while (p < end && !isspace((unsigned char)*p)) ++p;
+    }
+    string rest(p, end);
+    if (rest.find("1/2-1/2") != string::npos || rest.find("[0.5]") != string::npos) return 0.5f;
+    if (rest.find("1-0") != string::npos || rest.find("[1.0]") != string::npos || rest.find("[1]") != string::npos) return 1.0f;
+    if (rest.find("0-1") != string::npos || rest.find("[0.0]") != string::npos || rest.find("[0]") != string::npos) return 0.0f;
+    return -1.0f;
+}
+
+static void addTerm(Dataset& data, int weight, int coefficient) {
+    if (coefficient == 0) return;
+    data.index.push_back((uint16_t)weight);
+    data.coef.push_back((int16_t)coefficient);
+}
+
+static Dataset loadCorpus(const string& path, int threads) {
+    ifstream file(path, ios::binary);
+    if (!file) {
+        cerr << "Cannot open corpus: " << path << endl;
+        return Dataset();
+    }
+    string text((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+    // Split the text at line boundaries, one slice per thread
+    vector<size_t> cuts(threads + 1, text.size());
+    cuts[0] = 0;
+    for (int t = 1; t < threads; ++t) {
+        size_t pos = text.size() * t / threads;
+        size_t newline = text.find('\n', pos);
+        cuts[t] = newline == string::npos ? text.size() : newline + 1;
+    }
+
+    vector<Dataset> parts(threads);
+    vector<size_t> skipped(threads, 0);
+
+    parallelFor(threads, threads, [&](int t, size_t, size_t) {
+        Dataset& data = parts[t];
+        Board board;
+        EvalFeatures features;
+        PawnHashTable pawnHash;  // per worker, as the table is not thread-safe
+        size_t pos = cuts[t];
+        while (pos < cuts[t + 1]) {
+            size_t end = text.find('\n', pos);
+            if (end == string::npos || end > cuts[t + 1]) end = cuts[t + 1];
+            const char* line = text.data() + pos;
+            const char* lineEnd = text.data() + end;
+            pos = end + 1;
+
+            float result = parseResult(line, lineEnd);
+            bool whiteTurn;
+            if (result < 0 || !board.loadFEN(string(line, lineEnd), whiteTurn)) {
+                if (lineEnd > line + 1) ++skipped[t];
+                continue;
+            }
+            // Terminal positions are scored outside the tuned evaluation
+            if (board.isCheckmate(true) || board.isCheckmate(false) ||
+                board.isStalemate(true) || board.isStalemate(false)) {
+                ++skipped[t];
+                continue;
+            }
+
+            Game::extractEvalFeatures(board, features, pawnHash);
+            data.result.push_back(result);
+            data.base.push_back((float)(features.material + features.fixed));
+            for (int i = 0; i < features.pstCount; ++i) {
+                const EvalFeatures::PstTerm& term = features.pst[i];
+                addTerm(data, term.piece * 64 + term.square, term.white ? 1 : -1);
+            }
+            addTerm(data, W_MOBILITY, features.mobility);
+            addTerm(data, W_CENTER, features.center);
+            addTerm(data, W_DEVELOPMENT, features.development);
+            addTerm(data, W_CASTLED, features.castled);
+            addTerm(data, W_CHECK, features.check);
+            data.begin.push_back((uint32_t)data.index.size());
+        }
+    });
+
+    Dataset all;
+    size_t skippedTotal = 0;
+    for (int t = 0; t < threads; ++t) {
+        all.append(parts[t]);
+        skippedTotal += skipped[t];
+    }
+    if (skippedTotal) cerr << "Skipped " << skippedTotal << " unlabelled, malformed or terminal lines" << endl;
+    return all;
+}
+
+// Evaluates positions [from, to) into evals (linear model, White's point of view)
+static void evaluateBatch(const Dataset& data, const vector<double>& weights,
+    size_t from, size_t to, float* evals) {
+    for (size_t i = from; i < to; ++i) {
+        double eval = data.base[i];
+        for (uint32_t t = data.begin[i]; t < data.begin[i + 1]; ++t)
+            eval += weights[data.index[t]] * data.coef[t];
+        evals[i - from] = (float)eval;
+    }
+}
+
+static const size_t BLOCK = 1024;
+
+static double computeLoss(const Dataset& data, const vector<double>& weights, double k, int threads) {
+    vector<double> partial(threads, 0.0);
+    double scale = k * log(10.0) / 400.0;
+    parallelFor(threads, data.size(), [&](int t, size_t from, size_t to) {
+        float evals[BLOCK];
+        double sum = 0.0;
+        for (size_t start = from; start < to; start += BLOCK) {
+            size_t stop = min(to, start + BLOCK);
+            evaluateBatch(data, weights, start, stop, evals);
+            // Dense pass over the block, kept apart from the sparse gathers above
+            for (size_t i = 0; i < stop - start; ++i) {
+                double s = 1.0 / (1.0 + exp(-scale * evals[i]));
+                double error = data.result[start + i] - s;
+                sum += error * error;
+            }
+        }
+        partial[t] = sum;
+    });
+    double total = 0.0;
+    for (double p : partial) total += p;
+    return total / max<size_t>(1, data.size());
+}
+
+// Golden-section search for the sigmoid scale that best fits the current weights
+static double findBestK(const Dataset& data, const vector<double>& weights, int threads) {
+    double lo = 0.05, hi = 3.0;
+    const double ratio = (sqrt(5.0) - 1.0) / 2.0;
+    double a = hi - ratio * (hi - lo), b = lo + ratio * (hi - lo);
+    double la = computeLoss(data, weights, a, threads), lb = computeLoss(data, weights, b, threads);
+    for (int i = 0; i < 30; ++i) {
+        if (la < lb) {
+            hi = b; b = a; lb = la;
+            a = hi - ratio * (hi - lo);
+            la = computeLoss(data, weights, a, threads);
+        }
+        else {
+            lo = a; a = b; la = lb;
+            b = lo + ratio * (hi - lo);
+            lb = computeLoss(data, weights, b, threads);
+        }
+    }
+    return (lo + hi) / 2.0;
+}
+
+// Adds the loss gradient of positions [from, to) into grad
+static void accumulateGradient(const Dataset& data, const vector<double>& weights, double scale,
+    size_t from, size_t to, vector<double>& grad) {
+    float evals[BLOCK];
+    float factor[BLOCK];
+    for (size_t start = from; start < to; start += BLOCK) {
+        size_t stop = min(to, start + BLOCK);
+        size_t n = stop - start;
+        evaluateBatch(data, weights, start, stop, evals);
+        for (size_t i = 0; i < n; ++i) {
+            double s = 1.0 / (1.0 + exp(-scale * evals[i]));
+            factor[i] = (float)(-2.0 * (data.result[start + i] - s) * s * (1.0 - s) * scale);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            size_t p = start + i;
+            for (uint32_t t = data.begin[p]; t < data.begin[p + 1]; ++t)
+                grad[data.index[t]] += factor[i] * data.coef[t];
+        }
+    }
+}
+
+static void writeHeader(const string& path, const vector<double>& weights, double loss, size_t positions) {
+    ofstream out(path);
+    out << "#pragma once\n";
+    out << "// Evaluation weights used by Game::evaluateBoard.\n";
+    out << "// tools/Tuner.cpp writes tuned values in exactly this layout, so a tuned\n";
+    out << "// header can replace this file directly.\n";
+    out << "// Tuned on " << positions << " positions, final loss " << loss << "\n\n";
+    out << "// Piece-square tables (from white's perspective)\n";
+    char buffer[16];
+    for (int table = 0; table < 6; ++table) {
+        out << "static const int " << tableNames[table] << "[8][8] = {\n";
+        for (int row = 0; row < 8; ++row) {
+            out << "    {";
+            for (int col = 0; col < 8; ++col) {
+                snprintf(buffer, sizeof(buffer), "%4d", (int)lround(weights[table * 64 + row * 8 + col]));
+                out << buffer << (col < 7 ? "," : "");
+            }
+            out << "}" << (row < 7 ? "," : "") << "\n";
+        }
+        out << "};\n\n";
+    }
+    out << "// Strategic weights, applied to White-minus-Black counts\n";
+    out << "static const int MOBILITY_WEIGHT = " << lround(weights[W_MOBILITY]) << ";         // per valid move\n";
+    out << "static const int CENTER_CONTROL_WEIGHT = " << lround(weights[W_CENTER]) << ";  // per move reaching d4, e4, d5 or e5\n";
+    out << "static const int DEVELOPMENT_WEIGHT = " << lround(weights[W_DEVELOPMENT]) << ";     // per minor/major piece off the back rank\n";
+    out << "static const int CASTLED_BONUS = " << lround(weights[W_CASTLED]) << ";          // king on a castled square\n";
+    out << "static const int CHECK_BONUS = " << lround(weights[W_CHECK]) << ";            // opponent king in check\n";
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--threads" && hasValue) options.threads = atoi(argv[++i]);
+        else if (arg == "--epochs" && hasValue) options.epochs = atoi(argv[++i]);
+        else if (arg == "--batch" && hasValue) options.batch = (size_t)atoll(argv[++i]);
+        else if (arg == "--rate" && hasValue) options.rate = atof(argv[++i]);
+        else if (arg == "--k" && hasValue) options.k = atof(argv[++i]);
+        else if (arg == "--out" && hasValue) options.out = argv[++i];
+        else if (options.corpus.empty() && arg[0] != '-') options.corpus = arg;
+        else {
+            cerr << "Unknown argument: " << arg << endl;
+            return 1;
+        }
+    }
+    if (options.corpus.empty()) {
+        cerr << "Usage: Tuner <corpus> [--threads N] [--epochs N] [--batch N] [--rate X] [--k X] [--out FILE]" << endl;
+        return 1;
+    }
+    int threads = options.threads > 0 ? options.threads : max(1u, thread::hardware_concurrency());
+    options.batch = max<size_t>(options.batch, BLOCK);
+
+    auto started = chrono::steady_clock::now();
+    auto elapsed = [&]() { return chrono::duration<double>(chrono::steady_clock::now() - started).count(); };
+
+    Dataset data = loadCorpus(options.corpus, threads);
+    if (data.size() == 0) {
+        cerr << "No usable positions in " << options.corpus << endl;
+        return 1;
+    }
+    cout << "Loaded " << data.size() << " positions with " << threads << " threads in " << elapsed() << "s" << endl;
+
+    vector<double> weights(WEIGHT_COUNT);
+    for (int table = 0; table < 6; ++table)
+        for (int square = 0; square < 64; ++square)
+            weights[table * 64 + square] = initialTables[table][square / 8][square % 8];
+    weights[W_MOBILITY] = MOBILITY_WEIGHT;
+    weights[W_CENTER] = CENTER_CONTROL_WEIGHT;
+    weights[W_DEVELOPMENT] = DEVELOPMENT_WEIGHT;
+    weights[W_CASTLED] = CASTLED_BONUS;
+    weights[W_CHECK] = CHECK_BONUS;
+
+    double k = options.k > 0 ? options.k : findBestK(data, weights, threads);
+    double scale = k * log(10.0) / 400.0;
+    cout << "K = " << k << ", initial loss " << computeLoss(data, weights, k, threads) << endl;
+
+    // Adam over contiguous mini-batches, visited in a shuffled order each epoch
+    vector<double> m(WEIGHT_COUNT, 0.0), v(WEIGHT_COUNT, 0.0);
+    const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    size_t batches = (data.size() + options.batch - 1) / options.batch;
+    vector<size_t> order(batches);
+    for (size_t i = 0; i < batches; ++i) order[i] = i;
+    mt19937 rng(12345);
+    vector<vector<double>> grads(threads, vector<double>(WEIGHT_COUNT));
+    long long step = 0;
+
+    for (int epoch = 1; epoch <= options.epochs; ++epoch) {
+        shuffle(order.begin(), order.end(), rng);
+        for (size_t batch : order) {
+            size_t from = batch * options.batch;
+            size_t to = min(data.size(), from + options.batch);
+            for (auto& grad : grads) fill(grad.begin(), grad.end(), 0.0);
+            parallelFor(threads, to - from, [&](int t, size_t a, size_t b) {
+                accumulateGradient(data, weights, scale, from + a, from + b, grads[t]);
+            });
+
+            ++step;
+            double correction1 = 1.0 - pow(beta1, (double)step);
+            double correction2 = 1.0 - pow(beta2, (double)step);
+            for (int w = 0; w < WEIGHT_COUNT; ++w) {
+                double g = 0.0;
+                for (int t = 0; t < threads; ++t) g += grads[t][w];
+                g /= (double)(to - from);
+                m[w] = beta1 * m[w] + (1.0 - beta1) * g;
+                v[w] = beta2 * v[w] + (1.0 - beta2) * g * g;
+                weights[w] -= options.rate * (m[w] / correction1) / (sqrt(v[w] / correction2) + epsilon);
+            }
+        }
+        if (epoch % 10 == 0 || epoch == options.epochs) {
+            cout << "Epoch " << epoch << ": loss " << computeLoss(data, weights, k, threads)
+                << " (" << elapsed() << "s)" << endl;
+        }
+    }
+
+    double loss = computeLoss(data, weights, k, threads);
+    writeHeader(options.out, weights, loss, data.size());
+    cout << "Wrote " << options.out << " (loss " << loss << ", " << elapsed() << "s total)" << endl;
+    return 0;
+}
@@ -0,0 +1,366 @@
+// UCI front-end for the engine over stdin/stdout.
+//
+// Commands are read on the main thread while the search runs on its own,
+// so stop, ponderhit and isready are answered during a search. With
+// Threads > 1 the extra threads search the same position into the shared
+// transposition table (lazy SMP) and only the main thread's result is
+// reported. Clock handling is done here: a timer raises the stop flag when
+// the move's budget is used up, or when a ponder search is converted by
+// ponderhit.
+//
+// Supported: uci, isready, ucinewgame, setoption (Hash, Threads, Ponder, TablebasePath),
+// position [startpos | fen ...] [moves ...], go (wtime btime winc binc
+// movestogo depth nodes movetime infinite ponder), stop, ponderhit, quit.
+
+#include "Game.h"
+#include "Tablebase.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+static const int MAX_THREADS = 64;
+
+class UciEngine {
+private:
+    shared_ptr<TranspositionTable> table = make_shared<TranspositionTable>();
+    vector<unique_ptr<Game>> engines;  // [0] reports the result, the rest are helpers
+    Board startBoard;
+    bool startWhite = true;
+    int startHalfmoveClock = 0;
+    vector<SimpleMove> moves;
+
+    thread searchThread;
+    atomic<bool> stop{ false };
+    mutex stateMutex;
+    condition_variable stateChanged;
+    bool mainDone = false;
+    bool pondering = false;
+    bool infinite = false;
+    bool stopRequested = false;
+    bool hasDeadline = false;
+    chrono::steady_clock::time_point deadline;
+    long long budgetMs = 0;
+
+    mutex outputMutex;
+
+    void send(const string& line) {
+        lock_guard<mutex> lock(outputMutex);
+        cout << line << endl;
+    }
+
+    void setThreads(int count) {
+        count = max(1, min(count, MAX_THREADS));
+        engines.resize(count);
+        for (auto& engine : engines) {
+            if (!engine) {
+                engine.reset(new Game());
+                engine->setTranspositionTable(table);
+            }
+        }
+        syncPositions();
+    }
+
+    void syncPositions() {
+        for (auto& engine : engines) {
+            engine->setPosition(startBoard, startWhite, startHalfmoveClock);
+            for (const SimpleMove& m : moves) engine->applyMove(m);
+        }
+    }
+
+    // "e2e4" / "e7e8q" on the given board; castling is the king's two-square move
+    static bool parseMove(const string& text, SimpleMove& move) {
+        if (text.size() < 4 || text.size() > 5) return false;
+        if (text[0] < 'a' || text[0] > 'h' || text[2] < 'a' || text[2] > 'h' ||
+            text[1] < '1' || text[1] > '8' || text[3] < '1' || text[3] > '8') return false;
+        if (text.size() == 5 && text[4] != 'q') return false;  // Board::movePiece only promotes to a queen
+        move = { '8' - text[1], text[0] - 'a', '8' - text[3], text[2] - 'a' };
+        return true;
+    }
+
+    void position(istringstream& in) {
+        string token;
+        in >> token;
+        string fen;
+        if (token == "startpos") {
+            fen = START_FEN;
+            in >> token;  // "moves" or nothing
+        }
+        else if (token == "fen") {
+            while (in >> token && token != "moves") fen += token + " ";
+        }
+        else {
+            return;
+        }
+
+        FenState state;
+        if (!startBoard.loadFEN(fen.c_str(), state)) {
+            send("info string invalid fen");
+            return;
+        }
+        startWhite = state.whiteTurn;
+        startHalfmoveClock = state.halfmoveClock;
+        moves.clear();
+
+        // Validate the moves on a scratch game, stopping at the first bad one
+        Game& game = *engines[0];
+        game.setPosition(startBoard, startWhite, startHalfmoveClock);
+        while (in >> token) {
+            SimpleMove move;
+            if (!parseMove(token, move) || !game.isLegalMove(move.fromRow, move.fromCol, move.toRow, move.toCol) ||
+                !game.applyMove(move)) {
+                send("info string illegal or unsupported move " + token);
+                break;
+            }
+            moves.push_back(move);
+        }
+        syncPositions();
+    }
+
+    void go(istringstream& in) {
+        SearchLimits limits;
+        limits.depth = 63;
+        limits.stop = &stop;
+        long long time[2] = { 0, 0 }, increment[2] = { 0, 0 };
+        int movesToGo = 0;
+        long long moveTime = 0;
+        bool ponder = false, isInfinite = false;
+        string token;
+        while (in >> token) {
+            if (token == "wtime") in >> time[0];
+            else if (token == "btime") in >> time[1];
+            else if (token == "winc") in >> increment[0];
+            else if (token == "binc") in >> increment[1];
+            else if (token == "movestogo") in >> movesToGo;
+            else if (token == "depth") in >> limits.depth;
+            else if (token == "nodes") in >> limits.nodes;
+            else if (token == "movetime") in >> moveTime;
+            else if (token == "infinite") isInfinite = true;
+            else if (token == "ponder") ponder = true;
+        }
+
+        // A share of the remaining time plus most of the increment
+        bool white = engines[0]->isWhiteTurn();
+        long long budget = moveTime;
+        if (budget == 0 && time[white ? 0 : 1] > 0) {
+            long long remaining = time[white ? 0 : 1];
+            budget = remaining / (movesToGo > 0 ? movesToGo : 30) + increment[white ? 0 : 1] * 3 / 4;
+            budget = max(1LL, min(budget, remaining - 50));
+        }
+
+        {
+            lock_guard<mutex> lock(stateMutex);
+            mainDone = false;
+            pondering = ponder;
+            infinite = isInfinite;
+            stopRequested = false;
+            budgetMs = budget;
+            hasDeadline = budget > 0 && !ponder && !isInfinite;
+            if (hasDeadline) deadline = chrono::steady_clock::now() + chrono::milliseconds(budget);
+        }
+        stop = false;
+        searchThread = thread(&UciEngine::runSearch, this, limits);
+    }
+
+    void runSearch(SearchLimits limits) {
+        bool white = engines[0]->isWhiteTurn();
+        vector<thread> helpers;
+        for (size_t i = 1; i < engines.size(); ++i) {
+            helpers.emplace_back([this, i, limits, white]() {
+                TRACE_THREAD_NAME("search helper");
+                SearchLimits helperLimits = limits;
+                helperLimits.depth = 63;
+                helperLimits.nodes = 0;
+                engines[i]->search(white, helperLimits);
+            });
+        }
+
+        SearchResult result;
+        thread mainSearch([&]() {
+            TRACE_THREAD_NAME("search");
+            engines[0]->setIterationCallback([this](const SearchResult& r) { sendInfo(r); });
+            result = engines[0]->search(white, limits);
+            engines[0]->setIterationCallback(SearchCallback());
+            lock_guard<mutex> lock(stateMutex);
+            mainDone = true;
+            stateChanged.notify_all();
+        });
+
+        // Timer: raise the stop flag at the deadline; after the search ends
+        // during ponder or infinite, hold the bestmove until ponderhit or stop
+        {
+            unique_lock<mutex> lock(stateMutex);
+            while (!mainDone || ((pondering || infinite) && !stopRequested)) {
+                if (hasDeadline && !mainDone) {
+                    if (stateChanged.wait_until(lock, deadline) == cv_status::timeout &&
+                        chrono::steady_clock::now() >= deadline) {
+                        stop = true;
+                        hasDeadline = false;
+                    }
+                }
+                else {
+                    stateChanged.wait(lock);
+                }
+            }
+        }
+        stop = true;
+        mainSearch.join();
+        for (thread& helper : helpers) helper.join();
+
+        const Board& board = engines[0]->getBoard();
+        if (result.bestMove.fromRow < 0) {
+            send("bestmove 0000");
+            return;
+        }
+        string line = "bestmove " + Game::moveToUci(board, result.bestMove);
+        if (result.pv.size() >= 2) {
+            Board next = board;
+            next.movePiece(result.bestMove.fromRow, result.bestMove.fromCol, result.bestMove.toRow,
+                result.bestMove.toCol, white);
+            line += " ponder " + Game::moveToUci(next, result.pv[1]);
+        }
+        send(line);
+    }
+
+    void sendInfo(const SearchResult& result) {
+        ostringstream line;
+        line << "info depth " << result.depth;
+        if (result.mateIn != 0) {
+            line << " score mate " << result.mateIn;
+        }
+        else {
+            line << " score cp " << result.score;
+        }
+        long long ms = (long long)(result.seconds * 1000);
+        line << " nodes " << result.nodes << " time " << ms;
+        if (ms > 0) line << " nps " << result.nodes * 1000 / ms;
+        line << " pv";
+        Board board = engines[0]->getBoard();
+        bool white = engines[0]->isWhiteTurn();
+        for (const SimpleMove& m : result.pv) {
+            line << ' ' << Game::moveToUci(board, m);
+            if (!board.movePiece(m.fromRow, m.fromCol, m.toRow, m.toCol, white)) break;
+            white = !white;
+        }
+        send(line.str());
+    }
+
+    void waitForSearch() {
+        if (searchThread.joinable()) searchThread.join();
+    }
+
+    void stopSearch() {
+        {
+            lock_guard<mutex> lock(stateMutex);
+            stopRequested = true;
+            pondering = false;
+            infinite = false;
+            stateChanged.notify_all();
+        }
+        stop = true;
+        waitForSearch();
+    }
+
+    void ponderHit() {
+        lock_guard<mutex> lock(stateMutex);
+        pondering = false;
+        if (budgetMs > 0 && !infinite) {
+            hasDeadline = true;
+            deadline = chrono::steady_clock::now() + chrono::milliseconds(budgetMs);
+        }
+        stateChanged.notify_all();
+    }
+
+    void setOption(istringstream& in) {
+        string token, name, value;
+        in >> token;  // "name"
+        while (in >> token && token != "value") name += (name.empty() ? "" : " ") + token;
+        getline(in >> ws, value);  // the rest of the line, so paths may contain spaces
+        if (name == "Hash") table->resize(max(1, atoi(value.c_str())));
+        else if (name == "Threads") setThreads(atoi(value.c_str()));
+        else if (name == "TablebasePath") {
+            if (value == "<empty>") value.clear();
+            int mapped = Tablebase::init(value);
+            send("info string " + to_string(mapped) + " tablebases mapped from " + value);
+        }
+        else if (name == "SyzygyPath") {
+            // Sent by GUIs unasked; say so rather than map nothing quietly
+            send("info string Syzygy tablebases are not supported; see TablebasePath");
+        }
+    }
+
+public:
+    UciEngine() {
+        FenState state;
+        startBoard.loadFEN(START_FEN, state);
+        setThreads(1);
+    }
+
+    void loop() {
+        string line;
+        while (getline(cin, line)) {
+            istringstream in(line);
+            string command;
+            in >> command;
+            if (command == "uci") {
+                send("id name Swag Chess");
+                send("id author eyk_1");
+                send("option name Hash type spin default " + to_string(TranspositionTable::DEFAULT_MEGABYTES) +
+                    " min 1 max 4096");
+                send("option name Threads type spin default 1 min 1 max " + to_string(MAX_THREADS));
+                send("option name Ponder type check default false");
+                send(string("option name TablebasePath type string default ") + Tablebase::DEFAULT_DIRECTORY);
+                send("uciok");
+            }
+            else if (command == "isready") {
+                send("readyok");
+            }
+            else if (command == "ucinewgame") {
+                stopSearch();
+                table->clear();
+            }
+            else if (command == "setoption") {
+                stopSearch();
+                setOption(in);
+            }
+            else if (command == "position") {
+                stopSearch();
+                position(in);
+            }
+            else if (command == "go") {
+                stopSearch();
+                go(in);
+            }
+            else if (command == "stop") {
+                stopSearch();
+            }
+            else if (command == "ponderhit") {
+                ponderHit();
+            }
+            else if (command == "quit") {
+                break;
+            }
+        }
+        stopSearch();
+    }
+};
+
+int main() {
+    Tablebase::init(Tablebase::DEFAULT_DIRECTORY);
+    UciEngine engine;
+    engine.loop();
+    TRACE_WRITE("uci_trace.json");
+    return 0;
+}